@@ -0,0 +1,85 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# Checks --update against a search of the whole cohort: searches an old cohort, folds new
+# individuals into it with --update and compares the updated PS1 and PS2 pools with those of a
+# search of old and new individuals together. The pools are not full and the old search used a
+# lower MIN_OBJ, which leaves the margin that makes the update exact, so they must match exactly.
+# PS2 must keep pairs with f1 >= MIN_OBJ whose obj is below MIN_OBJ. Invoked by 'make check'.
+#---------------------------------------------------------------------------------------------------
+set -e
+
+CHECK_DIR=${CHECK_DIR:-build/check}
+CHECK_MIN_OBJ=${CHECK_MIN_OBJ:-0.08}
+CHECK_OLD_MIN_OBJ=${CHECK_OLD_MIN_OBJ:-0.04}
+MPIRUN=${MPIRUN:-mpirun}
+
+rm -rf "$CHECK_DIR"
+mkdir -p "$CHECK_DIR/old" "$CHECK_DIR/new" "$CHECK_DIR/whole"
+
+GEN="$CHECK_DIR/../gen-cohort --exprs 30 --sparsity 0.6 --na-rate 0 --planted 0"
+$GEN --cases 100 --ctrls 100 --seed 1 --out "$CHECK_DIR/old.tsv"
+$GEN --cases 20 --ctrls 20 --seed 2 --out "$CHECK_DIR/new.tsv"
+
+# The whole cohort lists the old and then the new cases, followed by the controls
+paste "$CHECK_DIR/old.tsv" "$CHECK_DIR/new.tsv" |
+  awk -F '\t' -v OFS='\t' '{
+    line = $1
+    for (j = 2; j <= 101; ++j) line = line OFS $j
+    for (j = 203; j <= 222; ++j) line = line OFS $j
+    for (j = 102; j <= 201; ++j) line = line OFS $j
+    for (j = 223; j <= 242; ++j) line = line OFS $j
+    print line
+  }' > "$CHECK_DIR/whole.tsv"
+
+# Writes the config of one run: <name> <num_cases> <num_ctrls> <min_obj>
+write_cfg() {
+  cat > "$CHECK_DIR/$1.cfg" <<CFG
+DATA_FILE       $CHECK_DIR/$1.tsv
+SCRATCH_DIR     $CHECK_DIR/$1/
+NUM_CASES       $2
+NUM_CTRLS       $3
+NUM_EXPRS       30
+NUM_HEAD_ROWS   1
+NUM_HEAD_COLS   1
+RISK            true
+MAX_PS          2
+MIN_OBJ         $4
+USE_SOL_POOL    true
+SOL_POOL_SIZE   100000
+MISSING_SYMBOL  NA
+SET_NA_TRUE     true
+HIGH_VALUE      1
+NORM_VALUE      0
+LOW_VALUE       -1
+POOL_FORMAT     both
+CFG
+}
+write_cfg old 100 100 "$CHECK_OLD_MIN_OBJ"
+write_cfg new 20 20 "$CHECK_MIN_OBJ"
+write_cfg whole 120 120 "$CHECK_MIN_OBJ"
+
+$MPIRUN -np 2 ./sync-greedy "$CHECK_DIR/old.cfg" 2> "$CHECK_DIR/old.log"
+$MPIRUN -np 1 ./sync-greedy "$CHECK_DIR/new.cfg" --update "$CHECK_DIR/old" 2> "$CHECK_DIR/new.log"
+$MPIRUN -np 2 ./sync-greedy "$CHECK_DIR/whole.cfg" 2> "$CHECK_DIR/whole.log"
+
+status=0
+for ps in 1 2; do
+  if ! grep -q "Updated PS$ps: .*, exact" "$CHECK_DIR/new.log"; then
+    echo "FAIL: updated PS$ps is not reported exact"
+    status=1
+  fi
+  if ! cmp -s <(./pool-to-tsv "$CHECK_DIR/new/ps$ps.solPool.bin" | sort) \
+              <(./pool-to-tsv "$CHECK_DIR/whole/ps$ps.solPool.bin" | sort); then
+    echo "FAIL: updated PS$ps pool differs from a search of the whole cohort"
+    status=1
+  fi
+done
+
+if ! ./pool-to-tsv "$CHECK_DIR/new/ps2.solPool.bin" |
+     awk -v m="$CHECK_MIN_OBJ" 'NR > 1 && $2 >= m && $1 < m { found = 1 } END { exit !found }'; then
+  echo "FAIL: updated PS2 pool has no pair with f1 >= MIN_OBJ > obj"
+  status=1
+fi
+
+[ $status -eq 0 ] && echo "--update check passed"
+exit $status
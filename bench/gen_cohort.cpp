@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Writes a synthetic cohort in the DATA_FILE layout: one header row, one
+// header column, cases first and then controls. Each entry is HIGH (1) or LOW
+// (-1) with probability sparsity/2, NA with probability na_rate and NORM (0)
+// otherwise. Planted patterns are written into a share of the cases.
+//------------------------------------------------------------------------------
+
+namespace {
+  struct Options {
+    std::size_t exprs = 1000;
+    std::size_t cases = 500;
+    std::size_t ctrls = 500;
+    double sparsity = 0.3;
+    double na_rate = 0.01;
+    std::size_t planted = 5;
+    std::size_t planted_size = 4;
+    double prevalence = 0.3;
+    unsigned seed = 1;
+    std::string out = "cohort.tsv";
+  };
+
+  void usage(const char *exe) {
+    fprintf(stderr, "Usage: %s [options]\n", exe);
+    fprintf(stderr, "  --exprs N         number of features (rows), each giving two bins (1000)\n");
+    fprintf(stderr, "  --cases N         number of cases (500)\n");
+    fprintf(stderr, "  --ctrls N         number of controls (500)\n");
+    fprintf(stderr, "  --sparsity P      probability that an entry is HIGH or LOW (0.3)\n");
+    fprintf(stderr, "  --na-rate P       probability that an entry is NA (0.01)\n");
+    fprintf(stderr, "  --planted N       number of planted patterns (5)\n");
+    fprintf(stderr, "  --planted-size N  features per planted pattern (4)\n");
+    fprintf(stderr, "  --prevalence P    share of cases carrying each planted pattern (0.3)\n");
+    fprintf(stderr, "  --seed N          random seed (1)\n");
+    fprintf(stderr, "  --out FILE        output file (cohort.tsv)\n");
+    exit(EXIT_FAILURE);
+  }
+
+  Options parse_options(int argc, char *argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+      if (i + 1 >= argc) {
+        usage(argv[0]);
+      }
+      const std::string key = argv[i];
+      const char *val = argv[++i];
+
+      if (key == "--exprs") opt.exprs = strtoul(val, nullptr, 10);
+      else if (key == "--cases") opt.cases = strtoul(val, nullptr, 10);
+      else if (key == "--ctrls") opt.ctrls = strtoul(val, nullptr, 10);
+      else if (key == "--sparsity") opt.sparsity = atof(val);
+      else if (key == "--na-rate") opt.na_rate = atof(val);
+      else if (key == "--planted") opt.planted = strtoul(val, nullptr, 10);
+      else if (key == "--planted-size") opt.planted_size = strtoul(val, nullptr, 10);
+      else if (key == "--prevalence") opt.prevalence = atof(val);
+      else if (key == "--seed") opt.seed = strtoul(val, nullptr, 10);
+      else if (key == "--out") opt.out = val;
+      else usage(argv[0]);
+    }
+
+    if (opt.planted * opt.planted_size > opt.exprs) {
+      fprintf(stderr, "ERROR - planted patterns need more features than --exprs\n");
+      exit(EXIT_FAILURE);
+    }
+    return opt;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  const Options opt = parse_options(argc, argv);
+  const std::size_t num_indiv = opt.cases + opt.ctrls;
+
+  std::mt19937_64 rng(opt.seed);
+  std::uniform_real_distribution<double> unif(0.0, 1.0);
+
+  // Planted pattern p uses features [p*planted_size, (p+1)*planted_size), each
+  // with a random direction, and is carried by a random subset of the cases
+  std::vector<int> planted_value(opt.exprs, 0);
+  std::vector<std::vector<bool>> carries(opt.planted, std::vector<bool>(opt.cases, false));
+  for (std::size_t p = 0; p < opt.planted; ++p) {
+    for (std::size_t k = 0; k < opt.planted_size; ++k) {
+      planted_value[p * opt.planted_size + k] = unif(rng) < 0.5 ? 1 : -1;
+    }
+    for (std::size_t j = 0; j < opt.cases; ++j) {
+      carries[p][j] = unif(rng) < opt.prevalence;
+    }
+  }
+
+  FILE *output;
+  if ((output = fopen(opt.out.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", opt.out.c_str());
+    return EXIT_FAILURE;
+  }
+
+  fprintf(output, "feature");
+  for (std::size_t j = 0; j < num_indiv; ++j) {
+    fprintf(output, j < opt.cases ? "\tcase%lu" : "\tctrl%lu", j < opt.cases ? j : j - opt.cases);
+  }
+  fprintf(output, "\n");
+
+  std::string line;
+  for (std::size_t i = 0; i < opt.exprs; ++i) {
+    line = "f" + std::to_string(i);
+    const std::size_t p = opt.planted_size > 0 ? i / opt.planted_size : opt.planted;
+
+    for (std::size_t j = 0; j < num_indiv; ++j) {
+      const double r = unif(rng);
+      const char *val;
+
+      if (p < opt.planted && j < opt.cases && carries[p][j]) {
+        val = planted_value[i] > 0 ? "1" : "-1";
+      } else if (r < opt.na_rate) {
+        val = "NA";
+      } else if (r < opt.na_rate + opt.sparsity / 2) {
+        val = "1";
+      } else if (r < opt.na_rate + opt.sparsity) {
+        val = "-1";
+      } else {
+        val = "0";
+      }
+      line += '\t';
+      line += val;
+    }
+    fprintf(output, "%s\n", line.c_str());
+  }
+
+  fclose(output);
+  return EXIT_SUCCESS;
+}
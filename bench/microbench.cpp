@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/ConfigParser.h"
+#include "../src/ExprsData.h"
+#include "../src/GreedyWorker.h"
+#include "../src/Numa.h"
+#include "../src/Parallel.h"
+#include "../src/PatternScorer.h"
+#include "../src/Run.h"
+#include "../src/SolPool.h"
+#include "../src/Timer.h"
+
+//------------------------------------------------------------------------------
+// Microbenchmarks of the main kernels. Run on a single rank:
+//   microbench <config_file> <output_json>
+// Results are written as a JSON array, one record per benchmark.
+//------------------------------------------------------------------------------
+
+namespace {
+  struct Result {
+    std::string name;
+    std::size_t iterations;
+    double seconds;
+  };
+
+  void write_results(const std::string &file_name, const std::vector<Result> &results) {
+    FILE *output;
+    if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
+      fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
+      exit(EXIT_FAILURE);
+    }
+
+    fprintf(output, "[\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      const Result &r = results[i];
+      fprintf(output, "  {\"name\": \"%s\", \"iterations\": %lu, \"seconds\": %.6f, \"per_iteration_us\": %.3f}%s\n",
+              r.name.c_str(), r.iterations, r.seconds, 1e6 * r.seconds / std::max<std::size_t>(r.iterations, 1),
+              i + 1 < results.size() ? "," : "");
+    }
+    fprintf(output, "]\n");
+    fclose(output);
+  }
+
+  void report(const Result &r) {
+    fprintf(stderr, "%-16s %10lu iterations %12.6f s %12.3f us/iteration\n", r.name.c_str(), r.iterations,
+            r.seconds, 1e6 * r.seconds / std::max<std::size_t>(r.iterations, 1));
+  }
+
+  Result bench_load(const ConfigParser &parser) {
+    Timer timer;
+    timer.start();
+    ExprsData data(parser);
+    timer.stop();
+    return Result{"exprs_load", 1, timer.elapsed_wall_time()};
+  }
+
+  Result bench_add_solution(const ConfigParser &parser, const std::size_t num_bins) {
+    const std::size_t num_inserts = 200000;
+    const std::size_t ps = 5;
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<std::size_t> bin(0, num_bins - 1);
+    std::uniform_real_distribution<double> freq(0.0, 1.0);
+
+    std::vector<Pattern> pats(num_inserts, Pattern(ps));
+    std::vector<double> f1(num_inserts);
+    for (std::size_t i = 0; i < num_inserts; ++i) {
+      for (auto &p : pats[i]) {
+        p = bin(rng);
+      }
+      f1[i] = freq(rng);
+    }
+
+    SolPool pool(parser.getSizeT("SOL_POOL_SIZE"));
+    Timer timer;
+    timer.start();
+    for (std::size_t i = 0; i < num_inserts; ++i) {
+      pool.add_solution(f1[i], 0.0, pats[i]);
+    }
+    timer.stop();
+    return Result{"add_solution", num_inserts, timer.elapsed_wall_time()};
+  }
+
+  // calc_ps2 appends its pair counts to markerPairs_part0.csv in SCRATCH_DIR,
+  // which is created if needed and the file removed afterwards so repeated
+  // runs do not grow it
+  Result bench_calc_ps2(const ConfigParser &parser, GreedyWorker &worker, const std::size_t num_bins,
+                        const double min_obj) {
+    const std::size_t num_tasks = std::min<std::size_t>(32, num_bins - 1);
+    const std::vector<Run> runs = Run::list(parser);
+    Run::make_dirs(parser, runs);
+    const std::string pairs_file = runs[0].scratch_dir + "markerPairs_part" +
+                                   std::to_string(Parallel::get_world_rank()) + ".csv";
+    remove(pairs_file.c_str());
+
+    Timer timer;
+    timer.start();
+    for (std::size_t t = 0; t < num_tasks; ++t) {
+      worker.run_ps2_task(t * (num_bins - 1) / num_tasks, min_obj);
+    }
+    timer.stop();
+    remove(pairs_file.c_str());
+    return Result{"calc_ps2", num_tasks, timer.elapsed_wall_time()};
+  }
+
+  // Parents are pairs of the best PS1 bins, which is roughly what the beam
+  // holds after PS2. Extended one task per parent, then as a single subtree.
+  std::vector<Result> bench_calc(GreedyWorker &worker, const ExprsData &data, const double min_obj) {
+    std::vector<Result> results;
+    std::vector<Pattern> singles;
+    for (std::size_t i = 0; i < data.get_num_bins(); ++i) {
+      singles.push_back(Pattern(1, i));
+    }
+    PatternScorer scorer(data, 1);
+    std::vector<Solution> ps1 = scorer.score(singles);
+    std::sort(ps1.begin(), ps1.end(), [](const Solution &a, const Solution &b) { return a.obj > b.obj; });
+
+    const std::size_t top = std::min<std::size_t>(9, ps1.size());
+    std::vector<Pattern> parents;
+    for (std::size_t i = 0; i < top; ++i) {
+      for (std::size_t j = i + 1; j < top; ++j) {
+        parents.push_back({ps1[i].pat[0], ps1[j].pat[0]});
+      }
+    }
+
+    Timer timer;
+    timer.start();
+    for (auto &p : parents) {
+      worker.run_task(p, min_obj);
+    }
+    timer.stop();
+    results.push_back(Result{"calc", parents.size(), timer.elapsed_wall_time()});
+
+    // The same parents as one task, sorted so they share their first bins
+    std::sort(parents.begin(), parents.end());
+    timer.restart();
+    worker.run_subtree_task(parents, min_obj);
+    timer.stop();
+    results.push_back(Result{"calc_subtree", parents.size(), timer.elapsed_wall_time()});
+    return results;
+  }
+
+  // Exact PS3 subtrees below the bins with the highest group 1 support
+  Result bench_exact(GreedyWorker &worker, const ExprsData &data, const double min_obj) {
+    std::vector<Pattern> singles;
+    for (std::size_t i = 0; i < data.get_num_bins(); ++i) {
+      singles.push_back(Pattern(1, i));
+    }
+    PatternScorer scorer(data, 1);
+    std::vector<Solution> ps1 = scorer.score(singles);
+    std::sort(ps1.begin(), ps1.end(), [](const Solution &a, const Solution &b) { return a.f1 > b.f1; });
+
+    const std::size_t num_tasks = std::min<std::size_t>(8, ps1.size());
+    Timer timer;
+    timer.start();
+    for (std::size_t t = 0; t < num_tasks; ++t) {
+      worker.run_exact_task(ps1[t].pat[0], 3, min_obj);
+    }
+    timer.stop();
+    return Result{"exact_ps3", num_tasks, timer.elapsed_wall_time()};
+  }
+
+  // Threaded scoring of random PS3 patterns under each NUMA_POLICY; every
+  // policy must give the scores of the first
+  std::vector<Result> bench_numa(ExprsData &data, const std::size_t num_threads) {
+    const std::size_t num_pats = 100000;
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<std::size_t> bin(0, data.get_num_bins() - 1);
+    std::vector<Pattern> pats(num_pats, Pattern(3));
+    for (auto &pat : pats) {
+      for (auto &p : pat) {
+        p = bin(rng);
+      }
+    }
+
+    const Numa::Policy old_policy = data.get_numa_policy();
+    std::vector<Result> results;
+    std::vector<Solution> expected;
+    for (auto policy : {Numa::NONE, Numa::PIN, Numa::INTERLEAVE, Numa::REPLICATE}) {
+      data.set_numa_policy(policy);
+      PatternScorer scorer(data, num_threads);
+
+      Timer timer;
+      timer.start();
+      std::vector<Solution> sols = scorer.score(pats);
+      timer.stop();
+
+      if (expected.empty()) {
+        expected = sols;
+      }
+      for (std::size_t i = 0; i < sols.size(); ++i) {
+        if (sols[i].f1 != expected[i].f1 || sols[i].f2 != expected[i].f2) {
+          fprintf(stderr, "ERROR - Scores differ under NUMA_POLICY %s\n", Numa::get_policy_name(policy));
+          exit(EXIT_FAILURE);
+        }
+      }
+      results.push_back(Result{std::string("score_") + Numa::get_policy_name(policy), num_pats,
+                               timer.elapsed_wall_time()});
+    }
+    data.set_numa_policy(old_policy);
+    return results;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(NULL, NULL);
+
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <config_file> <output_json>\n", argv[0]);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  try {
+    ConfigParser parser(argv[1]);
+    const double min_obj = parser.getDouble("MIN_OBJ");
+    std::vector<Result> results;
+
+    results.push_back(bench_load(parser));
+    report(results.back());
+
+    ExprsData data(parser);
+    GreedyWorker worker(parser);
+    fprintf(stderr, "Sparse bins: %lu of %lu\n", data.get_num_sparse(), data.get_num_bins());
+
+    results.push_back(bench_add_solution(parser, data.get_num_bins()));
+    report(results.back());
+
+    results.push_back(bench_calc_ps2(parser, worker, data.get_num_bins(), min_obj));
+    report(results.back());
+
+    for (auto &r : bench_calc(worker, data, min_obj)) {
+      results.push_back(r);
+      report(r);
+    }
+
+    results.push_back(bench_exact(worker, data, min_obj));
+    report(results.back());
+
+    fprintf(stderr, "NUMA nodes: %lu\n", Numa::get_nodes().size());
+    for (auto &r : bench_numa(data, parser.hasParameter("NUM_THREADS") ? parser.getSizeT("NUM_THREADS") : 1)) {
+      results.push_back(r);
+      report(r);
+    }
+
+    write_results(argv[2], results);
+  } catch (std::exception &e) {
+    fprintf(stderr, "  *** Fatal error: %s *** \n", e.what());
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
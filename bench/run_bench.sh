@@ -0,0 +1,86 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# Generates a synthetic cohort, runs the microbenchmarks and an end-to-end multi-level run, and
+# writes the results to $BENCH_DIR/results.json. Invoked by 'make bench'; every parameter below can
+# be overridden from the environment.
+#---------------------------------------------------------------------------------------------------
+set -e
+
+BENCH_DIR=${BENCH_DIR:-build/bench}
+BENCH_EXPRS=${BENCH_EXPRS:-2000}
+BENCH_CASES=${BENCH_CASES:-500}
+BENCH_CTRLS=${BENCH_CTRLS:-500}
+BENCH_SPARSITY=${BENCH_SPARSITY:-0.3}
+BENCH_NA_RATE=${BENCH_NA_RATE:-0.01}
+BENCH_PLANTED=${BENCH_PLANTED:-5}
+BENCH_PLANTED_SIZE=${BENCH_PLANTED_SIZE:-4}
+BENCH_SEED=${BENCH_SEED:-1}
+BENCH_NP=${BENCH_NP:-4}
+BENCH_THREADS=${BENCH_THREADS:-4}
+BENCH_SPARSE_DENSITY=${BENCH_SPARSE_DENSITY:-0}
+BENCH_MAX_PS=${BENCH_MAX_PS:-5}
+BENCH_MIN_OBJ=${BENCH_MIN_OBJ:-0.1}
+BENCH_POOL_SIZE=${BENCH_POOL_SIZE:-1000}
+MPIRUN=${MPIRUN:-mpirun}
+
+mkdir -p "$BENCH_DIR/scratch"
+rm -f "$BENCH_DIR"/scratch/*
+DATA_FILE="$BENCH_DIR/cohort.tsv"
+CFG_FILE="$BENCH_DIR/bench.cfg"
+
+"$BENCH_DIR/../gen-cohort" --exprs "$BENCH_EXPRS" --cases "$BENCH_CASES" --ctrls "$BENCH_CTRLS" \
+  --sparsity "$BENCH_SPARSITY" --na-rate "$BENCH_NA_RATE" --planted "$BENCH_PLANTED" \
+  --planted-size "$BENCH_PLANTED_SIZE" --seed "$BENCH_SEED" --out "$DATA_FILE"
+
+cat > "$CFG_FILE" <<CFG
+DATA_FILE       $DATA_FILE
+SCRATCH_DIR     $BENCH_DIR/scratch/
+NUM_CASES       $BENCH_CASES
+NUM_CTRLS       $BENCH_CTRLS
+NUM_EXPRS       $BENCH_EXPRS
+NUM_HEAD_ROWS   1
+NUM_HEAD_COLS   1
+RISK            true
+MAX_PS          $BENCH_MAX_PS
+MIN_OBJ         $BENCH_MIN_OBJ
+USE_SOL_POOL    true
+SOL_POOL_SIZE   $BENCH_POOL_SIZE
+MISSING_SYMBOL  NA
+SET_NA_TRUE     true
+HIGH_VALUE      1
+NORM_VALUE      0
+LOW_VALUE       -1
+NUM_THREADS     $BENCH_THREADS
+SPARSE_DENSITY  $BENCH_SPARSE_DENSITY
+CFG
+
+"$BENCH_DIR/../microbench" "$CFG_FILE" "$BENCH_DIR/micro.json"
+
+start=$(date +%s.%N)
+$MPIRUN -np "$BENCH_NP" ./sync-greedy "$CFG_FILE"
+stop=$(date +%s.%N)
+
+# Per-level wall times from the ps#.stats.json files
+levels=""
+for ps in $(seq 1 "$BENCH_MAX_PS"); do
+  stats="$BENCH_DIR/scratch/ps$ps.stats.json"
+  [ -f "$stats" ] || continue
+  wall=$(sed -n 's/.*"wall_time": \([0-9.]*\).*/\1/p' "$stats")
+  levels="$levels${levels:+, }{\"ps\": $ps, \"wall_time\": $wall}"
+done
+
+cat > "$BENCH_DIR/results.json" <<JSON
+{
+  "revision": "$(git rev-parse --short HEAD 2>/dev/null || echo unknown)",
+  "date": "$(date -u +%Y-%m-%dT%H:%M:%SZ)",
+  "params": {"exprs": $BENCH_EXPRS, "cases": $BENCH_CASES, "ctrls": $BENCH_CTRLS,
+             "sparsity": $BENCH_SPARSITY, "na_rate": $BENCH_NA_RATE, "planted": $BENCH_PLANTED,
+             "planted_size": $BENCH_PLANTED_SIZE, "seed": $BENCH_SEED, "ranks": $BENCH_NP,
+             "threads": $BENCH_THREADS, "sparse_density": $BENCH_SPARSE_DENSITY,
+             "max_ps": $BENCH_MAX_PS, "min_obj": $BENCH_MIN_OBJ, "sol_pool_size": $BENCH_POOL_SIZE},
+  "microbenchmarks": $(cat "$BENCH_DIR/micro.json"),
+  "end_to_end": {"seconds": $(awk "BEGIN {printf \"%.3f\", $stop - $start}"), "levels": [$levels]}
+}
+JSON
+
+echo "Results written to $BENCH_DIR/results.json"
@@ -0,0 +1,115 @@
+#include "BootstrapScorer.h"
+#include <algorithm>
+#include <random>
+#include "Threads.h"
+#include "Utils.h"
+
+const std::size_t BootstrapScorer::REPLICATE_BATCH;
+
+BootstrapScorer::BootstrapScorer(const ExprsData &_data, const std::size_t _num_threads,
+                                 const uint64_t _seed) : data(&_data),
+                                                         num_threads(_num_threads > 0 ? _num_threads : 1),
+                                                         seed(_seed) {}
+
+BootstrapScorer::~BootstrapScorer() {}
+
+//------------------------------------------------------------------------------
+// Builds the bit-sliced multiplicities of group 1 and group 2 for replicates
+// [first, first+num). Plane b of replicate k at word w is
+// planes[(w*num + k)*num_planes + b]. Returns num_planes, the number of bits
+// of the largest multiplicity in the batch.
+//------------------------------------------------------------------------------
+std::size_t BootstrapScorer::make_planes(const std::size_t first, const std::size_t num,
+                                         std::vector<uint64_t> &planes1, std::vector<uint64_t> &planes2) const {
+  const std::size_t num_words = data->get_num_words();
+  const std::size_t num_indivs = 64 * num_words;
+  std::vector<std::vector<uint32_t>> weights(num, std::vector<uint32_t>(num_indivs, 0));
+
+  uint32_t max_weight = 1;
+  for (std::size_t k = 0; k < num; ++k) {
+    std::seed_seq seq{seed, static_cast<uint64_t>(first + k)};
+    std::mt19937_64 rng(seq);
+
+    for (auto indivs : {&data->get_grp1_indivs(), &data->get_grp2_indivs()}) {
+      std::uniform_int_distribution<std::size_t> pick(0, indivs->size() - 1);
+      for (std::size_t i = 0; i < indivs->size(); ++i) {
+        max_weight = std::max(max_weight, ++weights[k][(*indivs)[pick(rng)]]);
+      }
+    }
+  }
+
+  std::size_t num_planes = 0;
+  while (max_weight >> num_planes) {
+    ++num_planes;
+  }
+
+  planes1.assign(num_words * num * num_planes, 0);
+  planes2.assign(num_words * num * num_planes, 0);
+  for (std::size_t k = 0; k < num; ++k) {
+    for (std::size_t j = 0; j < num_indivs; ++j) {
+      if (weights[k][j] == 0) {
+        continue;
+      }
+
+      const bool in_grp1 = (data->get_grp1_mask()[j / 64] >> (j % 64)) & 1;
+      uint64_t *plane = &(in_grp1 ? planes1 : planes2)[((j / 64) * num + k) * num_planes];
+      for (std::size_t b = 0; b < num_planes; ++b) {
+        plane[b] |= static_cast<uint64_t>((weights[k][j] >> b) & 1) << (j % 64);
+      }
+    }
+  }
+  return num_planes;
+}
+
+//------------------------------------------------------------------------------
+// Sets objs[i*(last-first) + r-first] to the obj of pattern i on replicate r,
+// for replicates [first, last). Patterns are spread over the threads.
+//------------------------------------------------------------------------------
+void BootstrapScorer::score(const std::vector<Pattern> &pats, const std::size_t first, const std::size_t last,
+                            std::vector<double> &objs) const {
+  const std::size_t num_words = data->get_num_words();
+  const std::size_t num_reps = last - first;
+  const double num_grp1 = data->get_num_grp1();
+  const double num_grp2 = data->get_num_grp2();
+
+  objs.assign(pats.size() * num_reps, 0.0);
+  std::vector<uint64_t> planes1, planes2;
+
+  for (std::size_t batch = first; batch < last; batch += REPLICATE_BATCH) {
+    const std::size_t num = std::min(REPLICATE_BATCH, last - batch);
+    const std::size_t num_planes = make_planes(batch, num, planes1, planes2);
+
+    Threads::parallel_for(pats.size(), BATCH_SIZE, num_threads, data->get_numa_policy(),
+                          [&](std::size_t b, std::size_t e) {
+      std::vector<uint64_t> cover;
+      std::size_t counts1[REPLICATE_BATCH], counts2[REPLICATE_BATCH];
+
+      for (std::size_t i = b; i < e; ++i) {
+        data->get_cover(pats[i], cover);
+
+        // One pass over the cover counts it against every plane of the batch
+        std::fill(counts1, counts1 + num, 0);
+        std::fill(counts2, counts2 + num, 0);
+        for (std::size_t w = 0; w < num_words; ++w) {
+          const uint64_t c = cover[w];
+          if (c == 0) {
+            continue;
+          }
+
+          const uint64_t *p1 = &planes1[w * num * num_planes];
+          const uint64_t *p2 = &planes2[w * num * num_planes];
+          for (std::size_t k = 0; k < num; ++k) {
+            for (std::size_t bit = 0; bit < num_planes; ++bit) {
+              counts1[k] += utils::popcount(c & p1[k * num_planes + bit]) << bit;
+              counts2[k] += utils::popcount(c & p2[k * num_planes + bit]) << bit;
+            }
+          }
+        }
+
+        for (std::size_t k = 0; k < num; ++k) {
+          objs[i * num_reps + batch - first + k] = counts1[k] / num_grp1 - counts2[k] / num_grp2;
+        }
+      }
+    });
+  }
+}
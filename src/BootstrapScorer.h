@@ -0,0 +1,36 @@
+#ifndef BOOTSTRAP_SCORER_H
+#define BOOTSTRAP_SCORER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ExprsData.h"
+#include "Solution.h"
+
+// Scores patterns on bootstrap replicates of the individuals without building
+// resampled matrices. Replicate r draws each group with replacement, keeping
+// its size, with a generator seeded from (seed, r), so any range of replicates
+// gives the same results on any rank. The multiplicity of each individual is
+// stored bit-sliced: plane b holds bit b of every multiplicity, so the
+// weighted count of a cover is the sum over planes of popcount(cover & plane)
+// shifted left by b.
+class BootstrapScorer {
+  private:
+    const ExprsData *data;
+    const std::size_t num_threads;
+    const uint64_t seed;
+
+    static const std::size_t REPLICATE_BATCH = 16;
+    static const std::size_t BATCH_SIZE = 64;
+
+    std::size_t make_planes(const std::size_t first, const std::size_t num, std::vector<uint64_t> &planes1,
+                            std::vector<uint64_t> &planes2) const;
+
+  public:
+    BootstrapScorer(const ExprsData &_data, const std::size_t _num_threads, const uint64_t _seed);
+    ~BootstrapScorer();
+
+    void score(const std::vector<Pattern> &pats, const std::size_t first, const std::size_t last,
+               std::vector<double> &objs) const;
+};
+
+#endif
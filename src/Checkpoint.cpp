@@ -0,0 +1,119 @@
+#include "Checkpoint.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include "PoolFile.h"
+
+namespace {
+  const char MAGIC[4] = {'S', 'G', 'C', 'K'};
+
+  // Parameters that may change between a run and its resumption: how the
+  // search is scheduled, placed and written, and the options of other modes
+  const std::set<std::string> UNHASHED_PARAMETERS = {"MAX_PS", "POOL_FORMAT", "SCRATCH_DIR", "SCHEDULER",
+                                                     "PS2_SCHEDULE", "WORKER_POOLS", "NUM_THREADS", "TRACE_FILE",
+                                                     "NUMA_POLICY", "SPARSE_DENSITY", "STOP_NO_IMPROVEMENT",
+                                                     "STOP_MIN_GAIN", "STOP_BELOW_MIN_OBJ", "STOP_POOL_FRACTION",
+                                                     "NUM_PERMUTATIONS", "PERMUTATION_SEED", "NUM_BOOTSTRAPS",
+                                                     "BOOTSTRAP_SEED"};
+}
+
+//------------------------------------------------------------------------------
+// Location of the checkpoint in the scratch directory
+//------------------------------------------------------------------------------
+std::string Checkpoint::file_name(const std::string &scratch_dir) {
+  return scratch_dir + "checkpoint.bin";
+}
+
+//------------------------------------------------------------------------------
+// FNV-1a hash of every parameter that affects the search results
+//------------------------------------------------------------------------------
+uint64_t Checkpoint::hash_config(const ConfigParser &parser) {
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (auto &name : parser.getParameterNames()) {
+    if (UNHASHED_PARAMETERS.count(name) > 0) {
+      continue;
+    }
+
+    const std::string line = name + "=" + parser.getString(name) + "\n";
+    for (auto c : line) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+// Writes the checkpoint to a temporary file and renames it into place, so an
+// interrupted write never replaces the previous checkpoint
+//------------------------------------------------------------------------------
+void Checkpoint::write(const std::string &file_name) const {
+  const std::string tmp_name = file_name + ".tmp";
+
+  FILE *output;
+  if ((output = fopen(tmp_name.c_str(), "wb")) == nullptr) {
+    fprintf(stderr, "ERROR - Checkpoint::write - Could not open file %s\n", tmp_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  const uint32_t version = VERSION;
+  const uint64_t level = ps;
+  const uint32_t stop = stopped;
+
+  if (fwrite(MAGIC, sizeof(char), 4, output) != 4 ||
+      fwrite(&version, sizeof(uint32_t), 1, output) != 1 ||
+      fwrite(&config_hash, sizeof(uint64_t), 1, output) != 1 ||
+      fwrite(&level, sizeof(uint64_t), 1, output) != 1 ||
+      fwrite(&lb, sizeof(double), 1, output) != 1 ||
+      fwrite(&stop, sizeof(uint32_t), 1, output) != 1) {
+    fprintf(stderr, "ERROR - Checkpoint::write - Could not write to file %s\n", tmp_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  PoolFile::write_stream(output, sols, tmp_name);
+
+  if (fflush(output) != 0 || fclose(output) != 0) {
+    fprintf(stderr, "ERROR - Checkpoint::write - Could not write to file %s\n", tmp_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  if (rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    perror("Checkpoint::write - rename");
+    exit(EXIT_FAILURE);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reads a checkpoint. Returns false if the file does not exist.
+//------------------------------------------------------------------------------
+bool Checkpoint::read(const std::string &file_name) {
+  FILE *input;
+  if ((input = fopen(file_name.c_str(), "rb")) == nullptr) {
+    return false;
+  }
+
+  char magic[4];
+  uint32_t version;
+  uint64_t level;
+  uint32_t stop = 0;
+
+  if (fread(magic, sizeof(char), 4, input) != 4 ||
+      fread(&version, sizeof(uint32_t), 1, input) != 1 ||
+      fread(&config_hash, sizeof(uint64_t), 1, input) != 1 ||
+      fread(&level, sizeof(uint64_t), 1, input) != 1 ||
+      fread(&lb, sizeof(double), 1, input) != 1 ||
+      memcmp(magic, MAGIC, 4) != 0 || version < 1 || version > VERSION ||
+      (version >= 2 && fread(&stop, sizeof(uint32_t), 1, input) != 1)) {
+    fprintf(stderr, "ERROR - Checkpoint::read - %s is not a version 1 to %lu checkpoint\n",
+            file_name.c_str(), VERSION);
+    exit(EXIT_FAILURE);
+  }
+  ps = level;
+  stopped = stop != 0;
+  sols = PoolFile::read_stream(input, file_name);
+
+  fclose(input);
+  return true;
+}
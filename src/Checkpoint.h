@@ -0,0 +1,42 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ConfigParser.h"
+#include "Solution.h"
+
+//------------------------------------------------------------------------------
+// State of a run after its last completed level. The file holds a small
+// header followed by the level's pool in the binary pool format:
+//
+//   char[4]  magic "SGCK"
+//   uint32   version
+//   uint64   config hash
+//   uint64   last completed pattern size
+//   double   lower bound at the end of the level
+//   uint32   1 if a stopping rule ended the run after this level (version 2)
+//   pool     see PoolFile.h
+//
+// Version 1 checkpoints are read as not stopped.
+//------------------------------------------------------------------------------
+struct Checkpoint {
+  static const std::size_t VERSION = 2;
+
+  uint64_t config_hash;
+  std::size_t ps;
+  double lb;
+  bool stopped;
+  std::vector<Solution> sols;
+
+  Checkpoint() : config_hash(0), ps(0), lb(0.0), stopped(false) {}
+
+  static std::string file_name(const std::string &scratch_dir);
+  static uint64_t hash_config(const ConfigParser &parser);
+
+  void write(const std::string &file_name) const;
+  bool read(const std::string &file_name);
+};
+
+#endif
@@ -423,6 +423,47 @@ std::string ConfigParser::getString(const std::string &parameterName) const
 }
 
 
+//------------------------------------------------------------------------------
+// Returns the comma separated items of the value mapped to the parameter. A
+// value without commas gives a list of one item.
+//------------------------------------------------------------------------------
+std::vector<std::string> ConfigParser::getList(const std::string &parameterName) const
+{
+  std::vector<std::string> items;
+  std::istringstream stream(findValue(parameterName));
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) {
+      throw std::runtime_error("ConfigParser: Empty item in the list given for '" + parameterName + "'");
+    }
+    items.push_back(item);
+  }
+  return items;
+}
+
+
+//------------------------------------------------------------------------------
+// Returns true if the parameter was provided in the config file
+//------------------------------------------------------------------------------
+bool ConfigParser::hasParameter(const std::string &parameterName) const
+{
+  return values.find(parameterName) != values.end();
+}
+
+
+//------------------------------------------------------------------------------
+// Returns the names of all parameters provided, in sorted order
+//------------------------------------------------------------------------------
+std::vector<std::string> ConfigParser::getParameterNames() const
+{
+  std::vector<std::string> names;
+  for (auto &v : values) {
+    names.push_back(v.first);
+  }
+  return names;
+}
+
+
 //------------------------------------------------------------------------------
 // Loads a config file and parses the information into the map
 //------------------------------------------------------------------------------
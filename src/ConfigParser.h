@@ -5,6 +5,7 @@
 #include <fstream>
 #include <map>
 #include <sstream>
+#include <vector>
 #include <algorithm>
 
 class ConfigParser {
@@ -27,6 +28,9 @@ class ConfigParser {
     short getShort(const std::string &) const;
     std::size_t getSizeT(const std::string &) const;
     std::string getString(const std::string &) const;
+    std::vector<std::string> getList(const std::string &) const;
+    bool hasParameter(const std::string &) const;
+    std::vector<std::string> getParameterNames() const;
 
     void load(const std::string &);
 };
@@ -0,0 +1,140 @@
+#include "CountCache.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "PoolFile.h"
+#include "Utils.h"
+
+namespace {
+  const char MAGIC[4] = {'S', 'G', 'C', 'C'};
+}
+
+//------------------------------------------------------------------------------
+// Location of the count cache in the scratch directory
+//------------------------------------------------------------------------------
+std::string CountCache::file_name(const std::string &scratch_dir) {
+  return scratch_dir + "counts.bin";
+}
+
+//------------------------------------------------------------------------------
+// Sets the group sizes and bin counts from the active individuals of data,
+// keeping the levels
+//------------------------------------------------------------------------------
+void CountCache::count_bins(const ExprsData &data) {
+  risk = data.get_risk();
+  const std::vector<uint64_t> &case_mask = risk ? data.get_grp1_mask() : data.get_grp2_mask();
+  const std::vector<uint64_t> &ctrl_mask = risk ? data.get_grp2_mask() : data.get_grp1_mask();
+  num_cases = risk ? data.get_num_grp1() : data.get_num_grp2();
+  num_ctrls = risk ? data.get_num_grp2() : data.get_num_grp1();
+
+  case_counts.assign(data.get_num_bins(), 0);
+  ctrl_counts.assign(data.get_num_bins(), 0);
+  for (std::size_t i = 0; i < data.get_num_bins(); ++i) {
+    case_counts[i] = data.count_bin(i, case_mask.data());
+    ctrl_counts[i] = data.count_bin(i, ctrl_mask.data());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes the cache to a temporary file and renames it into place
+//------------------------------------------------------------------------------
+void CountCache::write(const std::string &file_name) const {
+  const std::string tmp_name = file_name + ".tmp";
+
+  FILE *output;
+  if ((output = fopen(tmp_name.c_str(), "wb")) == nullptr) {
+    fprintf(stderr, "ERROR - CountCache::write - Could not open file %s\n", tmp_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  const uint32_t version = VERSION;
+  const uint64_t sizes[2] = {num_cases, num_ctrls};
+  const uint32_t flags[2] = {risk ? 1u : 0u, 0};
+  const uint64_t num_bins = case_counts.size();
+  const uint64_t num_levels = levels.size();
+
+  bool ok = fwrite(MAGIC, sizeof(char), 4, output) == 4 &&
+            fwrite(&version, sizeof(uint32_t), 1, output) == 1 &&
+            fwrite(sizes, sizeof(uint64_t), 2, output) == 2 &&
+            fwrite(flags, sizeof(uint32_t), 2, output) == 2 &&
+            fwrite(&num_bins, sizeof(uint64_t), 1, output) == 1 &&
+            fwrite(case_counts.data(), sizeof(uint64_t), num_bins, output) == num_bins &&
+            fwrite(ctrl_counts.data(), sizeof(uint64_t), num_bins, output) == num_bins &&
+            fwrite(&num_levels, sizeof(uint64_t), 1, output) == 1;
+  for (std::size_t k = 0; ok && k < levels.size(); ++k) {
+    const uint64_t max_size = levels[k].max_size;
+    const uint32_t level_flags[2] = {levels[k].exact ? 1u : 0u, 0};
+    ok = fwrite(&levels[k].min_obj, sizeof(double), 1, output) == 1 &&
+         fwrite(&max_size, sizeof(uint64_t), 1, output) == 1 &&
+         fwrite(level_flags, sizeof(uint32_t), 2, output) == 2;
+    if (ok) {
+      PoolFile::write_stream(output, levels[k].sols, tmp_name);
+    }
+  }
+
+  if (!ok || fflush(output) != 0 || fclose(output) != 0) {
+    fprintf(stderr, "ERROR - CountCache::write - Could not write to file %s\n", tmp_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  if (rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    perror("CountCache::write - rename");
+    exit(EXIT_FAILURE);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reads a count cache. Returns false if the file does not exist.
+//------------------------------------------------------------------------------
+bool CountCache::read(const std::string &file_name) {
+  FILE *input;
+  if ((input = fopen(file_name.c_str(), "rb")) == nullptr) {
+    return false;
+  }
+
+  char magic[4];
+  uint32_t version;
+  uint64_t sizes[2];
+  uint32_t flags[2];
+  uint64_t num_bins = 0, num_levels = 0;
+
+  bool ok = fread(magic, sizeof(char), 4, input) == 4 &&
+            fread(&version, sizeof(uint32_t), 1, input) == 1 &&
+            memcmp(magic, MAGIC, 4) == 0 && version == VERSION &&
+            fread(sizes, sizeof(uint64_t), 2, input) == 2 &&
+            fread(flags, sizeof(uint32_t), 2, input) == 2 &&
+            fread(&num_bins, sizeof(uint64_t), 1, input) == 1;
+  if (ok) {
+    case_counts.resize(num_bins);
+    ctrl_counts.resize(num_bins);
+    ok = fread(case_counts.data(), sizeof(uint64_t), num_bins, input) == num_bins &&
+         fread(ctrl_counts.data(), sizeof(uint64_t), num_bins, input) == num_bins &&
+         fread(&num_levels, sizeof(uint64_t), 1, input) == 1;
+  }
+  if (!ok) {
+    fprintf(stderr, "ERROR - CountCache::read - %s is not a version %lu count cache\n",
+            file_name.c_str(), VERSION);
+    exit(EXIT_FAILURE);
+  }
+  num_cases = sizes[0];
+  num_ctrls = sizes[1];
+  risk = flags[0] != 0;
+
+  levels.resize(num_levels);
+  for (auto &level : levels) {
+    uint64_t max_size;
+    uint32_t level_flags[2];
+    if (fread(&level.min_obj, sizeof(double), 1, input) != 1 ||
+        fread(&max_size, sizeof(uint64_t), 1, input) != 1 ||
+        fread(level_flags, sizeof(uint32_t), 2, input) != 2) {
+      fprintf(stderr, "ERROR - CountCache::read - %s is truncated\n", file_name.c_str());
+      exit(EXIT_FAILURE);
+    }
+    level.max_size = max_size;
+    level.exact = level_flags[0] != 0;
+    level.sols = PoolFile::read_stream(input, file_name);
+  }
+
+  fclose(input);
+  return true;
+}
@@ -0,0 +1,61 @@
+#ifndef COUNT_CACHE_H
+#define COUNT_CACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ExprsData.h"
+#include "Solution.h"
+
+//------------------------------------------------------------------------------
+// Counts a run keeps next to its pools so that individuals appended to the
+// cohort can be folded in later without the old data (see --update): the
+// number of cases and controls searched, how many of each have every bin, and
+// the pool of each level with the MIN_OBJ and SOL_POOL_SIZE it was found with.
+// A pattern's counts are its f1 and f2 times the group sizes. exact is false
+// for a level an update could not prove to match a full search.
+//
+//   char[4]  magic "SGCC"
+//   uint32   version
+//   uint64   number of cases, number of controls
+//   uint32   1 for risk pools, 0 for protective ones
+//   uint32   reserved
+//   uint64   number of bins
+//   uint64   cases with each bin (x bins), then controls with each bin
+//   uint64   number of levels
+//   level:   double   MIN_OBJ
+//            uint64   SOL_POOL_SIZE
+//            uint32   exact
+//            uint32   reserved
+//            pool     see PoolFile.h
+//------------------------------------------------------------------------------
+struct CountCache {
+  static const std::size_t VERSION = 1;
+
+  struct Level {
+    double min_obj;
+    std::size_t max_size;
+    bool exact;
+    std::vector<Solution> sols;
+
+    Level() : min_obj(0.0), max_size(0), exact(false) {}
+  };
+
+  std::size_t num_cases;
+  std::size_t num_ctrls;
+  bool risk;
+  std::vector<uint64_t> case_counts;
+  std::vector<uint64_t> ctrl_counts;
+  std::vector<Level> levels;
+
+  CountCache() : num_cases(0), num_ctrls(0), risk(true) {}
+
+  static std::string file_name(const std::string &scratch_dir);
+
+  void count_bins(const ExprsData &data);
+
+  void write(const std::string &file_name) const;
+  bool read(const std::string &file_name);
+};
+
+#endif
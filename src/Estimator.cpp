@@ -0,0 +1,576 @@
+#include "Estimator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include "GreedyController.h"
+#include "Parallel.h"
+#include "SolPool.h"
+#include "Solution.h"
+#include "Timer.h"
+#include "Utils.h"
+
+const std::size_t Estimator::SAMPLE_ANALYTES;
+const std::size_t Estimator::SAMPLE_WORDS;
+
+namespace {
+  // Used when the estimate runs on a single rank and cannot measure MPI
+  const double ASSUMED_LATENCY = 5e-6;
+  const double ASSUMED_BANDWIDTH = 2e9;
+
+  const double KERNEL_SECONDS = 0.05;
+
+  const double MB = 1024.0 * 1024.0;
+}
+
+Estimator::Estimator(const ConfigParser &parser, const std::size_t _num_ranks) :
+    num_cases(parser.getSizeT("NUM_CASES")),
+    num_ctrls(parser.getSizeT("NUM_CTRLS")),
+    num_analytes(parser.getSizeT("NUM_EXPRS")),
+    num_bins(num_analytes * 2),
+    num_words((num_cases + num_ctrls + 63) / 64),
+    num_ranks(_num_ranks),
+    runs(Run::list(parser)),
+    configured{parser.hasParameter("SPARSE_DENSITY") ? parser.getDouble("SPARSE_DENSITY") : 0.0,
+               parser.hasParameter("SCHEDULER") ? parser.getString("SCHEDULER") : "central",
+               parser.hasParameter("WORKER_POOLS") && parser.getBool("WORKER_POOLS"),
+               Numa::parse_policy(parser.hasParameter("NUMA_POLICY") ? parser.getString("NUMA_POLICY") : "none")},
+    lookup_seconds(0.0),
+    word_seconds(0.0),
+    sparse_seconds(0.0),
+    latency(ASSUMED_LATENCY),
+    bandwidth(ASSUMED_BANDWIDTH),
+    mpi_measured(false) {
+  if (num_ranks < 2) {
+    throw std::runtime_error("Estimator: A search needs at least 2 ranks");
+  }
+  sample_data(parser);
+  for (auto &r : runs) {
+    if (sample_freqs[r.risk].empty()) {
+      search_sample(r.risk);
+    }
+  }
+}
+
+Estimator::~Estimator() {}
+
+//------------------------------------------------------------------------------
+// Reads the first SAMPLE_ANALYTES analytes of DATA_FILE (fewer for very large
+// cohorts) and records their bins and the share of the cases and of the
+// controls in each
+//------------------------------------------------------------------------------
+void Estimator::sample_data(const ConfigParser &parser) {
+  const std::string data_file = parser.getString("DATA_FILE");
+  std::ifstream input(data_file);
+  if (!input) {
+    fprintf(stderr, "ERROR: Could not open data file %s\n", data_file.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  const std::size_t num_head_rows = parser.getSizeT("NUM_HEAD_ROWS");
+  const std::size_t num_head_cols = parser.getSizeT("NUM_HEAD_COLS");
+  const std::size_t num_indivs = num_cases + num_ctrls;
+  const std::string missing = parser.getString("MISSING_SYMBOL");
+  const bool set_na_true = parser.getBool("SET_NA_TRUE");
+  const std::string high = parser.getString("HIGH_VALUE");
+  const std::string low = parser.getString("LOW_VALUE");
+
+  std::string field;
+  for (std::size_t j = 0; j < num_head_rows * (num_head_cols + num_indivs); ++j) {
+    if (!(input >> field)) {
+      fprintf(stderr, "ERROR: Could not find all header rows (%s)\n", data_file.c_str());
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  const std::size_t num_sampled = std::max<std::size_t>(1, std::min(std::min(num_analytes, SAMPLE_ANALYTES),
+                                                                    SAMPLE_WORDS / (2 * num_words)));
+  sample_bins.assign(2 * num_sampled * num_words, 0);
+  for (std::size_t i = 0; i < num_sampled; ++i) {
+    std::size_t counts[2][2] = {{0, 0}, {0, 0}};
+    uint64_t *bins = &sample_bins[2 * i * num_words];
+    for (std::size_t j = 0; j < num_head_cols + num_indivs; ++j) {
+      if (!(input >> field)) {
+        fprintf(stderr, "ERROR: Input file is missing data (%s)\n", data_file.c_str());
+        exit(EXIT_FAILURE);
+      }
+      if (j < num_head_cols) {
+        continue;
+      }
+
+      const std::size_t indiv = j - num_head_cols;
+      const std::size_t grp = indiv < num_cases ? 0 : 1;
+      const bool na = set_na_true && field == missing;
+      for (std::size_t k = 0; k < 2; ++k) {
+        if (na || field == (k == 0 ? high : low)) {
+          ++counts[k][grp];
+          bins[k * num_words + indiv / 64] |= static_cast<uint64_t>(1) << (indiv % 64);
+        }
+      }
+    }
+
+    for (std::size_t k = 0; k < 2; ++k) {
+      case_freqs.push_back(static_cast<double>(counts[k][0]) / num_cases);
+      ctrl_freqs.push_back(static_cast<double>(counts[k][1]) / num_ctrls);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Times the inner loops of the search on synthetic bins as wide as the
+// configured cohort: testing a bin at each individual of a list (dense
+// candidates in calc), ANDing and counting bitset words (covers and the exact
+// search) and testing the individuals of a sparse bin against a cover
+//------------------------------------------------------------------------------
+void Estimator::calibrate() {
+  const std::size_t num_indivs = num_cases + num_ctrls;
+  const std::size_t max_words = static_cast<std::size_t>(1) << 23;
+  const std::size_t kernel_bins = std::max<std::size_t>(1, std::min(num_bins, max_words / num_words));
+
+  std::mt19937_64 rng(1);
+  std::vector<uint64_t> bins(kernel_bins * num_words), cover(num_words);
+  for (auto &w : bins) {
+    w = rng() & rng();
+  }
+  for (auto &w : cover) {
+    w = rng();
+  }
+  std::vector<uint32_t> indivs;
+  for (std::size_t j = 0; j < num_indivs; ++j) {
+    if (rng() % 4 == 0 || indivs.empty()) {
+      indivs.push_back(j);
+    }
+  }
+
+  std::size_t count = 0, ops = 0;
+  Timer timer;
+  timer.start();
+  while (timer.elapsed_wall_time() < KERNEL_SECONDS) {
+    const uint64_t *bin = &bins[(rng() % kernel_bins) * num_words];
+    for (auto j : indivs) {
+      count += (bin[j / 64] >> (j % 64)) & 1;
+    }
+    ops += indivs.size();
+  }
+  lookup_seconds = timer.elapsed_wall_time() / ops;
+
+  ops = 0;
+  timer.restart();
+  while (timer.elapsed_wall_time() < KERNEL_SECONDS) {
+    const uint64_t *bin = &bins[(rng() % kernel_bins) * num_words];
+    for (std::size_t w = 0; w < num_words; ++w) {
+      count += utils::popcount(cover[w] & bin[w]);
+    }
+    ops += num_words;
+  }
+  word_seconds = timer.elapsed_wall_time() / ops;
+
+  ops = 0;
+  timer.restart();
+  while (timer.elapsed_wall_time() < KERNEL_SECONDS) {
+    const std::size_t first = rng() % indivs.size();
+    const std::size_t last = std::min(indivs.size(), first + 64);
+    for (std::size_t k = first; k < last; ++k) {
+      count += (cover[indivs[k] / 64] >> (indivs[k] % 64)) & 1;
+    }
+    ops += last - first;
+  }
+  sparse_seconds = timer.elapsed_wall_time() / ops;
+
+  // Keeps the kernels from being optimized away
+  if (count == 0) {
+    fprintf(stderr, "\n");
+  }
+}
+
+//------------------------------------------------------------------------------
+// Measures the latency and bandwidth between ranks 0 and 1 with ping-pongs.
+// Rank 1 must call echo_mpi at the same time.
+//------------------------------------------------------------------------------
+void Estimator::calibrate_mpi() {
+  const int num_small = 1000, num_large = 20;
+  std::vector<char> buffer(4 << 20);
+
+  Timer timer;
+  timer.start();
+  for (int i = 0; i < num_small; ++i) {
+    MPI_Send(buffer.data(), 1, MPI_CHAR, 1, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD);
+    MPI_Recv(buffer.data(), 1, MPI_CHAR, 1, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  }
+  latency = timer.elapsed_wall_time() / (2 * num_small);
+
+  timer.restart();
+  for (int i = 0; i < num_large; ++i) {
+    MPI_Send(buffer.data(), buffer.size(), MPI_CHAR, 1, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD);
+    MPI_Recv(buffer.data(), 1, MPI_CHAR, 1, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  }
+  bandwidth = num_large * buffer.size() / std::max(1e-9, timer.elapsed_wall_time() - 2 * num_large * latency);
+  mpi_measured = true;
+}
+
+void Estimator::echo_mpi() {
+  const int num_small = 1000, num_large = 20;
+  std::vector<char> buffer(4 << 20);
+
+  for (int i = 0; i < num_small; ++i) {
+    MPI_Recv(buffer.data(), 1, MPI_CHAR, 0, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Send(buffer.data(), 1, MPI_CHAR, 0, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD);
+  }
+  for (int i = 0; i < num_large; ++i) {
+    MPI_Recv(buffer.data(), buffer.size(), MPI_CHAR, 0, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Send(buffer.data(), 1, MPI_CHAR, 0, Parallel::ESTIMATE_TAG, MPI_COMM_WORLD);
+  }
+}
+
+const Estimator::Settings & Estimator::get_configured() const {
+  return configured;
+}
+
+//------------------------------------------------------------------------------
+// The configured settings first, then every other combination of dense or
+// sparse storage, scheduler and worker pools, and interleave in place of
+// replicate
+//------------------------------------------------------------------------------
+std::vector<Estimator::Settings> Estimator::get_candidates() const {
+  std::vector<Settings> candidates(1, configured);
+
+  std::vector<double> densities{configured.sparse_density};
+  for (double d : {0.0, 1.0 / 32}) {
+    if (d != configured.sparse_density) {
+      densities.push_back(d);
+    }
+  }
+  std::vector<Numa::Policy> policies{configured.numa_policy};
+  if (configured.numa_policy == Numa::REPLICATE) {
+    policies.push_back(Numa::INTERLEAVE);
+  }
+
+  for (auto d : densities) {
+    for (const char *scheduler : {"central", "distributed"}) {
+      for (bool worker_pools : {false, true}) {
+        for (auto policy : policies) {
+          Settings s{d, scheduler, worker_pools, policy};
+          if (s.sparse_density != configured.sparse_density || s.scheduler != configured.scheduler ||
+              s.worker_pools != configured.worker_pools || s.numa_policy != configured.numa_policy) {
+            candidates.push_back(s);
+          }
+        }
+      }
+    }
+  }
+  return candidates;
+}
+
+//------------------------------------------------------------------------------
+// Bytes of the stored bins, extrapolated from the sampled ones
+//------------------------------------------------------------------------------
+double Estimator::get_bin_bytes(const double sparse_density) const {
+  double words = 0.0;
+  for (std::size_t b = 0; b < case_freqs.size(); ++b) {
+    const double size = case_freqs[b] * num_cases + ctrl_freqs[b] * num_ctrls;
+    const double sparse_words = std::ceil(size / 2);
+    const bool sparse = sparse_density > 0.0 && size <= sparse_density * (num_cases + num_ctrls) &&
+                        sparse_words < num_words;
+    words += sparse ? sparse_words : num_words;
+  }
+  return case_freqs.empty() ? 0.0 : 8.0 * words / case_freqs.size() * num_bins;
+}
+
+double Estimator::get_sparse_share(const double sparse_density) const {
+  std::size_t count = 0;
+  for (std::size_t b = 0; b < case_freqs.size(); ++b) {
+    const double size = case_freqs[b] * num_cases + ctrl_freqs[b] * num_ctrls;
+    count += sparse_density > 0.0 && size <= sparse_density * (num_cases + num_ctrls) &&
+             std::ceil(size / 2) < num_words;
+  }
+  return case_freqs.empty() ? 0.0 : static_cast<double>(count) / case_freqs.size();
+}
+
+double Estimator::get_mean_sparse_size(const double sparse_density) const {
+  double total = 0.0;
+  std::size_t count = 0;
+  for (std::size_t b = 0; b < case_freqs.size(); ++b) {
+    const double size = case_freqs[b] * num_cases + ctrl_freqs[b] * num_ctrls;
+    if (sparse_density > 0.0 && size <= sparse_density * (num_cases + num_ctrls) &&
+        std::ceil(size / 2) < num_words) {
+      total += size;
+      ++count;
+    }
+  }
+  return count > 0 ? total / count : 0.0;
+}
+
+//------------------------------------------------------------------------------
+// Greedy search over the sampled bins with a pool small enough to run in well
+// under a second, up to the largest MAX_PS of the direction. The mean group
+// frequencies of each level's pool stand in for the parent supports of the
+// next level of the full search.
+//------------------------------------------------------------------------------
+void Estimator::search_sample(const bool risk) {
+  std::size_t max_ps = 0, pool_size = 0;
+  double min_obj = 1.0;
+  for (auto &r : runs) {
+    if (r.risk == risk) {
+      max_ps = std::max(max_ps, r.max_ps);
+      pool_size = std::max(pool_size, r.sol_pool_size);
+      min_obj = std::min(min_obj, r.min_obj);
+    }
+  }
+
+  const std::size_t num_sampled = sample_bins.size() / num_words;
+  const std::size_t sample_pool = std::min(pool_size, std::max<std::size_t>(16, SAMPLE_WORDS / sample_bins.size()));
+  const double n1 = risk ? num_cases : num_ctrls;
+  const double n2 = risk ? num_ctrls : num_cases;
+
+  // Group 1 is the cases for risk
+  std::vector<uint64_t> grp1(num_words, 0);
+  for (std::size_t j = risk ? 0 : num_cases; j < (risk ? num_cases : num_cases + num_ctrls); ++j) {
+    grp1[j / 64] |= static_cast<uint64_t>(1) << (j % 64);
+  }
+
+  std::vector<std::pair<double, double>> &freqs = sample_freqs[risk];
+  freqs.assign(1, std::make_pair(1.0, 1.0));
+  std::vector<Solution> parents(1);
+  std::vector<uint64_t> cover(num_words);
+  for (std::size_t k = 1; k <= max_ps && !parents.empty(); ++k) {
+    SolPool pool(sample_pool);
+    for (auto &parent : parents) {
+      std::fill(cover.begin(), cover.end(), ~static_cast<uint64_t>(0));
+      for (auto p : parent.pat) {
+        for (std::size_t w = 0; w < num_words; ++w) {
+          cover[w] &= sample_bins[p * num_words + w];
+        }
+      }
+
+      const std::size_t first = parent.pat.empty() ? 0 : parent.pat.back() + 1;
+      for (std::size_t b = first; b < num_sampled; ++b) {
+        const uint64_t *bin = &sample_bins[b * num_words];
+        std::size_t count1 = 0, count2 = 0;
+        for (std::size_t w = 0; w < num_words; ++w) {
+          const uint64_t both = cover[w] & bin[w];
+          count1 += utils::popcount(both & grp1[w]);
+          count2 += utils::popcount(both & ~grp1[w]);
+        }
+        const double f1 = count1 / n1, f2 = count2 / n2;
+        if (f1 >= min_obj && f1 - f2 >= min_obj) {
+          Pattern pat = parent.pat;
+          pat.push_back(b);
+          pool.add_solution(f1, f2, pat);
+        }
+      }
+    }
+
+    parents = pool.get_solutions();
+    double f1 = 0.0, f2 = 0.0;
+    for (auto &sol : parents) {
+      f1 += sol.f1 / parents.size();
+      f2 += sol.f2 / parents.size();
+    }
+    if (!parents.empty()) {
+      freqs.push_back(std::make_pair(f1, f2));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Peak memory of the loaded data on every rank, with the transient copies
+// while NUMA_POLICY places it
+//------------------------------------------------------------------------------
+double Estimator::get_data_bytes(const Settings &settings) const {
+  const double num_indivs = num_cases + num_ctrls;
+  const double bin_bytes = get_bin_bytes(settings.sparse_density);
+  const double copies = settings.numa_policy == Numa::REPLICATE ? Numa::get_nodes().size() : 1;
+  const bool placed = settings.numa_policy == Numa::INTERLEAVE || settings.numa_policy == Numa::REPLICATE;
+  const double peak_bins = bin_bytes * (placed ? 1.0 + copies : 1.0);
+  return peak_bins + 17.0 * num_bins + 48.0 * num_words + 48.0 * num_indivs + 48.0 * num_analytes;
+}
+
+//------------------------------------------------------------------------------
+// Peak memory of rank 0 and of a worker: the data and the solution pools and
+// per-level buffers each keeps
+//------------------------------------------------------------------------------
+double Estimator::get_controller_bytes(const Settings &settings) const {
+  std::size_t pool_size = 0, max_ps = 0;
+  bool risk = false, protective = false;
+  for (auto &r : runs) {
+    pool_size = std::max(pool_size, r.sol_pool_size);
+    max_ps = std::max(max_ps, r.max_ps);
+    risk = risk || r.risk;
+    protective = protective || !r.risk;
+  }
+
+  // Two pools of list nodes, the level caches, the count cache and the copy
+  // handed to the pool writer. RISK both adds the mirror pool and the level
+  // caches of the other direction.
+  const double node_bytes = sizeof(Solution) + 32.0;
+  const double both = (risk && protective) ? 1.0 : 0.0;
+  return get_data_bytes(settings) + pool_size * ((2.0 + both) * node_bytes +
+                                                 (max_ps + 3.0 + 2.0 * both) * sizeof(Solution));
+}
+
+double Estimator::get_worker_bytes(const Settings &settings) const {
+  std::size_t pool_size = 0, max_ps = 0;
+  bool risk = false, protective = false;
+  for (auto &r : runs) {
+    pool_size = std::max(pool_size, r.sol_pool_size);
+    max_ps = std::max(max_ps, r.max_ps);
+    risk = risk || r.risk;
+    protective = protective || !r.risk;
+  }
+
+  // One pool, the PS2 counts, the screening sample and, with the distributed
+  // scheduler, the broadcast parents. RISK both adds the mirror pool and its
+  // PS2 counts.
+  const double node_bytes = sizeof(Solution) + 32.0;
+  const double copies = (risk && protective) ? 2.0 : 1.0;
+  double bytes = get_data_bytes(settings) + copies * (pool_size * node_bytes + 8.0 * num_bins) + num_cases + num_ctrls;
+  if (settings.scheduler == "distributed") {
+    bytes += 4.0 * pool_size * max_ps;
+  }
+  return bytes;
+}
+
+//------------------------------------------------------------------------------
+// Tasks, messages, bytes and seconds of each level of one run
+//------------------------------------------------------------------------------
+std::vector<Estimator::Level> Estimator::get_run_levels(const Run &run, const Settings &settings) const {
+  const double num_workers = num_ranks - 1;
+  const double tree_depth = std::ceil(std::log2(num_ranks));
+  const double n1 = run.risk ? num_cases : num_ctrls;
+  const double n2 = run.risk ? num_ctrls : num_cases;
+  const double pool = run.sol_pool_size;
+  const double B = num_bins;
+
+  const std::vector<double> &freqs1 = run.risk ? case_freqs : ctrl_freqs;
+  const std::vector<double> &freqs2 = run.risk ? ctrl_freqs : case_freqs;
+  double mean1 = 0.0, mean2 = 0.0;
+  for (std::size_t b = 0; b < freqs1.size(); ++b) {
+    mean1 += freqs1[b] / freqs1.size();
+    mean2 += freqs2[b] / freqs2.size();
+  }
+  const std::vector<std::pair<double, double>> &sample = sample_freqs[run.risk];
+
+  // Seconds to score one candidate bin against a parent with the given group
+  // frequencies, for the dense and sparse shares of the bins
+  const double sparse_share = get_sparse_share(settings.sparse_density);
+  const double sparse_size = get_mean_sparse_size(settings.sparse_density);
+  auto candidate_seconds = [&](const double f1, const double f2) {
+    return (1.0 - sparse_share) * (f1 * n1 + f2 * n2) * lookup_seconds +
+           sparse_share * 2.0 * sparse_size * sparse_seconds;
+  };
+
+  std::vector<Level> levels;
+  for (std::size_t k = 1; k <= run.max_ps; ++k) {
+    Level level;
+    level.ps = k;
+
+    const double sol_bytes = 4.0 * k + 24.0;
+    double returned = 0.0, compute = 0.0;
+    if (k == 1) {
+      level.tasks = num_workers;
+      returned = num_workers * std::min(pool, B / num_workers);
+      compute = 4.0 * B * num_words * word_seconds;
+    } else if (k == 2) {
+      level.tasks = B - 1;
+      for (double i = 0; i < B - 1; ++i) {
+        returned += std::min(pool, B - 1 - i);
+      }
+      compute = B * ((n1 + n2) * lookup_seconds + num_words * word_seconds) +
+                B * (B - 1) / 2 * candidate_seconds(mean1, mean2);
+    } else {
+      // Levels the sample search did not reach keep its last supports
+      const std::pair<double, double> &parent = sample[std::min(k - 1, sample.size() - 1)];
+      const double f1 = std::max(run.min_obj, parent.first);
+      const double f2 = std::min(f1, parent.second);
+      // Each task is a run of subtrees of the sorted parents
+      level.tasks = std::min(pool, static_cast<double>(GreedyController::SUBTREES_PER_WORKER) * num_workers);
+      returned = level.tasks * std::min(pool, B - k + 1);
+      compute = pool * ((n1 + n2) * (k - 1) * lookup_seconds + (k - 1) * num_words * word_seconds +
+                        (B - k + 1) * candidate_seconds(f1, f2));
+    }
+
+    const double request_bytes = 16.0 + 4.0 * (k - 1) * (k >= 3 ? pool / level.tasks : 1.0) + 8.0;
+    if (k >= 3 && settings.scheduler == "distributed") {
+      // Parents are broadcast and the worker pools reduced, both over a tree
+      level.messages = 2.0 * num_workers;
+      level.bytes = num_workers * pool * (4.0 * (k - 1) + sol_bytes);
+      level.controller_seconds = tree_depth * (2.0 * latency + pool * (4.0 * (k - 1) + sol_bytes) / bandwidth);
+    } else if (settings.worker_pools) {
+      // Each task reports a threshold; the pools are reduced once at the end
+      level.messages = 4.0 * level.tasks + num_workers;
+      level.bytes = level.tasks * (request_bytes + 8.0) + num_workers * pool * sol_bytes;
+      level.controller_seconds = 4.0 * level.tasks * latency + level.tasks * (request_bytes + 8.0) / bandwidth +
+                                 tree_depth * (latency + pool * sol_bytes / bandwidth);
+    } else {
+      // Each returned solution is a pattern and a values message
+      level.messages = 4.0 * level.tasks + 2.0 * returned;
+      level.bytes = level.tasks * (request_bytes + 8.0) + returned * sol_bytes;
+      level.controller_seconds = level.messages * latency + level.bytes / bandwidth;
+    }
+
+    level.compute_seconds = compute / num_workers;
+    level.seconds = std::max(level.compute_seconds, level.controller_seconds);
+    levels.push_back(level);
+  }
+  return levels;
+}
+
+//------------------------------------------------------------------------------
+// Levels of the whole job: each PS summed over the runs
+//------------------------------------------------------------------------------
+std::vector<Estimator::Level> Estimator::get_levels(const Settings &settings) const {
+  std::vector<Level> levels;
+  for (auto &r : runs) {
+    for (auto &l : get_run_levels(r, settings)) {
+      if (levels.size() < l.ps) {
+        levels.push_back(Level{l.ps, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0});
+      }
+      Level &total = levels[l.ps - 1];
+      total.tasks += l.tasks;
+      total.messages += l.messages;
+      total.bytes += l.bytes;
+      total.compute_seconds += l.compute_seconds;
+      total.controller_seconds += l.controller_seconds;
+      total.seconds += l.seconds;
+    }
+  }
+  return levels;
+}
+
+double Estimator::get_seconds(const Settings &settings) const {
+  double seconds = 0.0;
+  for (auto &l : get_levels(settings)) {
+    seconds += l.seconds;
+  }
+  return seconds;
+}
+
+void Estimator::report(FILE *stream, const Settings &settings) const {
+  double density = 0.0;
+  for (std::size_t b = 0; b < case_freqs.size(); ++b) {
+    density += (case_freqs[b] * num_cases + ctrl_freqs[b] * num_ctrls) / (num_cases + num_ctrls) /
+               case_freqs.size();
+  }
+
+  fprintf(stream, "Estimate for %lu ranks (%lu workers), %lu run(s)\n", num_ranks, num_ranks - 1, runs.size());
+  fprintf(stream, "Data: %lu bins, %lu individuals, %lu analytes sampled, mean bin density %.4f\n", num_bins,
+          num_cases + num_ctrls, case_freqs.size() / 2, density);
+  fprintf(stream, "Calibration: %.3f ns per bit lookup, %.3f ns per bitset word, %.3f ns per sparse index\n",
+          1e9 * lookup_seconds, 1e9 * word_seconds, 1e9 * sparse_seconds);
+  fprintf(stream, "MPI: %.2f us latency, %.2f GB/s (%s)\n", 1e6 * latency, bandwidth / 1e9,
+          mpi_measured ? "measured between ranks 0 and 1" : "assumed; run on 2 ranks to measure");
+  fprintf(stream, "Settings: SPARSE_DENSITY %g, SCHEDULER %s, WORKER_POOLS %s, NUMA_POLICY %s\n",
+          settings.sparse_density, settings.scheduler.c_str(), settings.worker_pools ? "true" : "false",
+          Numa::get_policy_name(settings.numa_policy));
+  fprintf(stream, "Peak memory per rank: controller %.1f MB, worker %.1f MB\n",
+          get_controller_bytes(settings) / MB, get_worker_bytes(settings) / MB);
+
+  fprintf(stream, "%4s %12s %14s %12s %12s %14s %12s\n", "PS", "tasks", "messages", "MB sent", "compute s",
+          "controller s", "wall s");
+  for (auto &l : get_levels(settings)) {
+    fprintf(stream, "%4lu %12.0f %14.0f %12.1f %12.3f %14.3f %12.3f\n", l.ps, l.tasks, l.messages, l.bytes / MB,
+            l.compute_seconds, l.controller_seconds, l.seconds);
+  }
+  fprintf(stream, "Estimated total: %.3f s\n", get_seconds(settings));
+}
@@ -0,0 +1,101 @@
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ConfigParser.h"
+#include "Numa.h"
+#include "Run.h"
+
+//------------------------------------------------------------------------------
+// Predicts the cost of a job before it is submitted (see --estimate): peak
+// memory per rank, and the tasks, messages, bytes and time of each level.
+// Bin densities come from the first analytes of DATA_FILE, and the time per
+// bit lookup, bitset word and sparse index from short kernels run on the local
+// CPU. MPI latency and bandwidth are measured between ranks 0 and 1 when the
+// estimate runs on two ranks or more, and assumed otherwise.
+//
+// Message counts and bytes assume every task returns a full pool, and compute
+// time assumes every candidate passes the f1 check, so both are upper bounds
+// for the central scheduler. Parent supports come from a small greedy search
+// over the sampled bins, and are never taken below MIN_OBJ.
+//------------------------------------------------------------------------------
+class Estimator {
+  public:
+    // Options the estimate depends on
+    struct Settings {
+      double sparse_density;
+      std::string scheduler;
+      bool worker_pools;
+      Numa::Policy numa_policy;
+    };
+
+    struct Level {
+      std::size_t ps;
+      double tasks;
+      double messages;
+      double bytes;
+      double compute_seconds;
+      double controller_seconds;
+      double seconds;
+    };
+
+  private:
+    const std::size_t num_cases;
+    const std::size_t num_ctrls;
+    const std::size_t num_analytes;
+    const std::size_t num_bins;
+    const std::size_t num_words;
+    const std::size_t num_ranks;
+    const std::vector<Run> runs;
+    const Settings configured;
+
+    // Share of the cases and of the controls with each sampled bin
+    std::vector<double> case_freqs;
+    std::vector<double> ctrl_freqs;
+
+    // Sampled bins as bitsets, and the mean group frequencies of the pool at
+    // each PS of the sample search, by direction (index 1 for risk)
+    std::vector<uint64_t> sample_bins;
+    std::vector<std::pair<double, double>> sample_freqs[2];
+
+    double lookup_seconds;
+    double word_seconds;
+    double sparse_seconds;
+    double latency;
+    double bandwidth;
+    bool mpi_measured;
+
+    static const std::size_t SAMPLE_ANALYTES = 1000;
+    static const std::size_t SAMPLE_WORDS = static_cast<std::size_t>(1) << 22;
+
+    void sample_data(const ConfigParser &parser);
+    double get_bin_bytes(const double sparse_density) const;
+    double get_data_bytes(const Settings &settings) const;
+    double get_sparse_share(const double sparse_density) const;
+    double get_mean_sparse_size(const double sparse_density) const;
+    void search_sample(const bool risk);
+    std::vector<Level> get_run_levels(const Run &run, const Settings &settings) const;
+
+  public:
+    Estimator(const ConfigParser &parser, const std::size_t _num_ranks);
+    ~Estimator();
+
+    void calibrate();
+    void calibrate_mpi();
+    static void echo_mpi();
+
+    const Settings & get_configured() const;
+    std::vector<Settings> get_candidates() const;
+
+    double get_controller_bytes(const Settings &settings) const;
+    double get_worker_bytes(const Settings &settings) const;
+    std::vector<Level> get_levels(const Settings &settings) const;
+    double get_seconds(const Settings &settings) const;
+
+    void report(FILE *stream, const Settings &settings) const;
+};
+
+#endif
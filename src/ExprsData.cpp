@@ -1,5 +1,10 @@
 #include "ExprsData.h"
+#include <algorithm>
 #include <assert.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "Utils.h"
 
 const std::size_t STRSIZE = 50;
 
@@ -8,31 +13,78 @@ ExprsData::ExprsData(const ConfigParser &parser) :  num_cases(parser.getSizeT("N
                                                     num_analytes(parser.getSizeT("NUM_EXPRS")),
                                                     num_header_rows(parser.getSizeT("NUM_HEAD_ROWS")),
                                                     num_header_cols(parser.getSizeT("NUM_HEAD_COLS")),
-                                                    risk(parser.getBool("RISK")),
-                                                    grp1_total(risk ? num_cases : num_ctrls),
+                                                    risk(parser.getString("RISK") == "both" || parser.getBool("RISK")),
+                                                    grp1_total(0),
                                                     grp1_start(risk ? 0 : num_cases),
                                                     grp1_stop(risk ? num_cases - 1 : num_cases + num_ctrls -1),
-                                                    grp2_total(risk ? num_ctrls : num_cases),
+                                                    grp2_total(0),
                                                     grp2_start(risk ? num_cases: 0),
                                                     grp2_stop(risk ? num_cases + num_ctrls -1 : num_cases -1),
                                                     num_bins_orig(num_analytes * 2),
+                                                    num_words((num_cases + num_ctrls + 63) / 64),
                                                     data_file(parser.getString("DATA_FILE")),
                                                     MISSING_SYMBOL(parser.getString("MISSING_SYMBOL")),
                                                     SET_NA_TRUE(parser.getBool("SET_NA_TRUE")),
                                                     HIGH_BIN(parser.getString("HIGH_VALUE")),
                                                     NORM_BIN(parser.getString("NORM_VALUE")),
-                                                    LOW_BIN(parser.getString("LOW_VALUE")) {
+                                                    LOW_BIN(parser.getString("LOW_VALUE")),
+                                                    fold_seed(parser.hasParameter("FOLD_SEED") ?
+                                                              parser.getSizeT("FOLD_SEED") : 1),
+                                                    annotation_file(parser.hasParameter("ANNOTATION_FILE") ?
+                                                                    parser.getString("ANNOTATION_FILE") : ""),
+                                                    sparse_density(parser.hasParameter("SPARSE_DENSITY") ?
+                                                                   parser.getDouble("SPARSE_DENSITY") : 0.0),
+                                                    numa_policy(Numa::NONE),
+                                                    bins(nullptr),
+                                                    num_stored_words(0),
+                                                    stratum_mask(get_all_mask()),
+                                                    active_mask(stratum_mask) {
   reduced_to_orig.resize(num_bins_orig);
   for (std::size_t i = 0; i < num_bins_orig; ++i) {
     reduced_to_orig[i] = i;
   }
 
   read_bin_data();
+  bins = bin_data.data();
+  num_stored_words = bin_data.size();
+  if (!annotation_file.empty()) {
+    read_annotations();
+    check_strata(parser);
+  }
+  build_group_masks();
+  set_numa_policy(Numa::parse_policy(parser.hasParameter("NUMA_POLICY") ?
+                                     parser.getString("NUMA_POLICY") : "none"));
 }
 
 ExprsData::~ExprsData() {}
 
+//------------------------------------------------------------------------------
+// Stores the bins of DATA_FILE. With SPARSE_DENSITY, a first pass over the file
+// counts the words the bins will take, so the storage is allocated once at its
+// final size and loading never holds more than the stored bins.
+//------------------------------------------------------------------------------
 void ExprsData::read_bin_data() {
+  std::size_t total_words = num_bins_orig * num_words;
+  if (sparse_density > 0.0) {
+    total_words = 0;
+    read_bins([this, &total_words](const uint64_t *words) {
+      total_words += get_stored_words(words);
+    });
+  }
+
+  bin_data.clear();
+  bin_data.reserve(total_words);
+  bin_offsets.clear();
+  bin_sizes.clear();
+  sparse_bins.clear();
+  read_bins([this](const uint64_t *words) { store_bin(words); });
+}
+
+//------------------------------------------------------------------------------
+// Reads DATA_FILE one analyte at a time and passes its HIGH and then its LOW
+// bin, as packed words, to use_bin
+//------------------------------------------------------------------------------
+void ExprsData::read_bins(const std::function<void(const uint64_t *)> &use_bin) {
   FILE *input;
   if ((input = fopen(data_file.c_str(), "r")) == nullptr) {
     perror("ExprsData::fopen");
@@ -41,10 +93,12 @@ void ExprsData::read_bin_data() {
 
   char strng[STRSIZE];
   analyte_names.resize(num_analytes);
-  std::vector<bool> data_row(num_cases+num_ctrls, false);
-  for (std::size_t i = 0; i < num_bins_orig; ++i) {
-    bin_data.push_back(data_row);
-  }
+
+  // HIGH and LOW bins of the analyte being read
+  std::vector<uint64_t> row(2 * num_words);
+  auto set_bin = [&](const std::size_t k, const std::size_t j) {
+    row[k * num_words + j / 64] |= static_cast<uint64_t>(1) << (j % 64);
+  };
 
 	// read in header rows
 	// read in first header row and disregard
@@ -56,11 +110,13 @@ void ExprsData::read_bin_data() {
 	}
 
   // Read in individuals
+  indiv_names.resize(num_cases + num_ctrls);
 	for (std::size_t j = 0; j < num_cases + num_ctrls; ++j) {
     if (fscanf(input, "%s", strng) <= 0) {
       fprintf(stderr, "ERROR: Could not find all individuals (%s)\n", data_file.c_str());
       exit(EXIT_FAILURE);
     }
+    indiv_names[j] = strng;
 	}
 
 	// read in rest of header rows and disregard
@@ -87,6 +143,7 @@ void ExprsData::read_bin_data() {
       }
 		}
 
+		std::fill(row.begin(), row.end(), 0);
 		for (std::size_t j = 0; j < num_cases + num_ctrls; ++j) {
 			if (feof(input)) {
         fprintf(stderr, "ERROR\n");
@@ -96,13 +153,13 @@ void ExprsData::read_bin_data() {
 			if (fscanf(input, "%s", strng) > 0) {
         if (MISSING_SYMBOL.compare(strng) == 0) {
           if (SET_NA_TRUE) {
-            bin_data[2*i][j] = true;
-            bin_data[2*i+1][j] = true;
+            set_bin(0, j);
+            set_bin(1, j);
           }                    
         } else if (HIGH_BIN.compare(strng) == 0) {
-          bin_data[2*i][j] = true;
+          set_bin(0, j);
         } else if (LOW_BIN.compare(strng) == 0) {
-          bin_data[2*i+1][j] = true;
+          set_bin(1, j);
         } else if (NORM_BIN.compare(strng) != 0) {
           fprintf(stderr, "ERROR: Unknown data type '%s' (%s)\n", strng, data_file.c_str());
           exit(EXIT_FAILURE);
@@ -112,10 +169,163 @@ void ExprsData::read_bin_data() {
         exit(EXIT_FAILURE);
       }            
 		}
+    use_bin(&row[0]);
+    use_bin(&row[num_words]);
   }
   fclose(input);
 }
 
+//------------------------------------------------------------------------------
+// Words a bin, given as packed words, takes in storage: half its individuals
+// rounded up if it is stored as an index list, otherwise num_words. Bins set
+// for at most SPARSE_DENSITY of the individuals are stored as index lists
+// when those take fewer words.
+//------------------------------------------------------------------------------
+std::size_t ExprsData::get_stored_words(const uint64_t *words) const {
+  std::size_t size = 0;
+  for (std::size_t w = 0; w < num_words; ++w) {
+    size += utils::popcount(words[w]);
+  }
+
+  const std::size_t sparse_words = (size + 1) / 2;
+  const bool sparse = sparse_density > 0.0 && size <= sparse_density * (num_cases + num_ctrls) &&
+                      sparse_words < num_words;
+  return sparse ? sparse_words : num_words;
+}
+
+//------------------------------------------------------------------------------
+// Appends the next bin, given as packed words, to the bin storage, as an
+// index list if get_stored_words says so
+//------------------------------------------------------------------------------
+void ExprsData::store_bin(const uint64_t *words) {
+  std::size_t size = 0;
+  for (std::size_t w = 0; w < num_words; ++w) {
+    size += utils::popcount(words[w]);
+  }
+
+  const std::size_t stored_words = get_stored_words(words);
+  const bool sparse = stored_words < num_words;
+
+  bin_offsets.push_back(bin_data.size());
+  bin_sizes.push_back(size);
+  sparse_bins.push_back(sparse);
+  if (!sparse) {
+    bin_data.insert(bin_data.end(), words, words + num_words);
+    return;
+  }
+
+  bin_data.resize(bin_data.size() + stored_words, 0);
+  uint32_t *indivs = reinterpret_cast<uint32_t *>(&bin_data[bin_offsets.back()]);
+  for (std::size_t w = 0; w < num_words; ++w) {
+    for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+      *indivs++ = w * 64 + __builtin_ctzll(word);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reads the annotation file: a header row with an ID column name followed by
+// the annotation column names, then one row per individual with its ID (as in
+// the first header row of the data file) and its value in each column.
+// Individuals without a row get no value in any column.
+//------------------------------------------------------------------------------
+void ExprsData::read_annotations() {
+  std::ifstream input(annotation_file);
+  if (!input) {
+    fprintf(stderr, "ERROR: Could not open annotation file %s\n", annotation_file.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  std::map<std::string, std::size_t> indiv_index;
+  for (std::size_t j = 0; j < indiv_names.size(); ++j) {
+    indiv_index[indiv_names[j]] = j;
+  }
+
+  std::string line, field;
+  std::vector<std::string> columns;
+  if (std::getline(input, line)) {
+    std::istringstream header(line);
+    header >> field;
+    while (header >> field) {
+      columns.push_back(field);
+      annotations[field].assign(indiv_names.size(), "");
+    }
+  }
+  if (columns.empty()) {
+    fprintf(stderr, "ERROR: Annotation file has no annotation columns (%s)\n", annotation_file.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  while (std::getline(input, line)) {
+    std::istringstream row(line);
+    if (!(row >> field)) {
+      continue;
+    }
+    auto it = indiv_index.find(field);
+
+    for (auto &column : columns) {
+      if (!(row >> field)) {
+        fprintf(stderr, "ERROR: Annotation row is missing values (%s)\n", annotation_file.c_str());
+        exit(EXIT_FAILURE);
+      }
+      if (it != indiv_index.end()) {
+        annotations[column][it->second] = field;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Makes sure every stratum in STRATA has cases and controls, and enough of
+// both for NUM_FOLDS, before any run starts
+//------------------------------------------------------------------------------
+void ExprsData::check_strata(const ConfigParser &parser) const {
+  if (!parser.hasParameter("STRATA")) {
+    return;
+  }
+  const std::size_t num_folds = parser.hasParameter("NUM_FOLDS") ? parser.getSizeT("NUM_FOLDS") : 0;
+
+  for (auto &stratum : parser.getList("STRATA")) {
+    const std::vector<uint64_t> mask = get_stratum_mask(stratum);
+    std::size_t counts[2] = {0, 0};
+    for (std::size_t j = 0; j < num_cases + num_ctrls; ++j) {
+      counts[j < num_cases ? 0 : 1] += (mask[j / 64] >> (j % 64)) & 1;
+    }
+
+    if (counts[0] == 0 || counts[1] == 0 || counts[0] < num_folds || counts[1] < num_folds) {
+      fprintf(stderr, "ERROR: Stratum %s has %lu cases and %lu controls\n", stratum.c_str(), counts[0], counts[1]);
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Rebuilds the masks, lists and sizes of both groups from the current
+// direction and active individuals
+//------------------------------------------------------------------------------
+void ExprsData::build_group_masks() {
+  grp1_mask.assign(num_words, 0);
+  grp2_mask.assign(num_words, 0);
+  grp1_indivs.clear();
+  grp2_indivs.clear();
+
+  for (std::size_t j = grp1_start; j <= grp1_stop; ++j) {
+    if ((active_mask[j / 64] >> (j % 64)) & 1) {
+      grp1_mask[j / 64] |= static_cast<uint64_t>(1) << (j % 64);
+      grp1_indivs.push_back(j);
+    }
+  }
+  for (std::size_t j = grp2_start; j <= grp2_stop; ++j) {
+    if ((active_mask[j / 64] >> (j % 64)) & 1) {
+      grp2_mask[j / 64] |= static_cast<uint64_t>(1) << (j % 64);
+      grp2_indivs.push_back(j);
+    }
+  }
+
+  grp1_total = grp1_indivs.size();
+  grp2_total = grp2_indivs.size();
+}
+
 const char* ExprsData::get_analyte_name(const std::size_t index) const {
   assert(index < analyte_names.size());
   return analyte_names[index].c_str();
@@ -130,13 +340,148 @@ std::size_t ExprsData::get_num_grp2() const {
 }
 
 std::size_t ExprsData::get_num_bins() const {
-  return bin_data.size();
+  return num_bins_orig;
 }
 
 bool ExprsData::get_risk() const {
   return risk;
 }
 
+//------------------------------------------------------------------------------
+// Makes the cases (risk) or the controls (protective) group 1 without
+// reloading the data
+//------------------------------------------------------------------------------
+void ExprsData::set_risk(const bool _risk) {
+  risk = _risk;
+  grp1_start = risk ? 0 : num_cases;
+  grp1_stop = risk ? num_cases - 1 : num_cases + num_ctrls - 1;
+  grp2_start = risk ? num_cases : 0;
+  grp2_stop = risk ? num_cases + num_ctrls - 1 : num_cases - 1;
+
+  build_group_masks();
+}
+
+//------------------------------------------------------------------------------
+// Restricts both groups to the individuals in mask without reloading the data
+//------------------------------------------------------------------------------
+void ExprsData::set_active(const std::vector<uint64_t> &mask) {
+  assert(mask.size() == num_words);
+  active_mask = mask;
+  build_group_masks();
+}
+
+//------------------------------------------------------------------------------
+// Returns the packed set of every case and control
+//------------------------------------------------------------------------------
+std::vector<uint64_t> ExprsData::get_all_mask() const {
+  std::vector<uint64_t> mask(num_words, 0);
+  for (std::size_t j = 0; j < num_cases + num_ctrls; ++j) {
+    mask[j / 64] |= static_cast<uint64_t>(1) << (j % 64);
+  }
+  return mask;
+}
+
+//------------------------------------------------------------------------------
+// Returns the individuals whose annotation matches stratum (<column>=<value>),
+// or every individual if stratum is empty
+//------------------------------------------------------------------------------
+std::vector<uint64_t> ExprsData::get_stratum_mask(const std::string &stratum) const {
+  if (stratum.empty()) {
+    return get_all_mask();
+  }
+
+  const std::size_t eq = stratum.find('=');
+  auto it = annotations.find(stratum.substr(0, eq));
+  if (eq == std::string::npos || it == annotations.end()) {
+    fprintf(stderr, "ERROR: Stratum %s does not name a column of %s\n", stratum.c_str(), annotation_file.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  const std::string value = stratum.substr(eq + 1);
+  std::vector<uint64_t> mask(num_words, 0);
+  for (std::size_t j = 0; j < num_cases + num_ctrls; ++j) {
+    if (it->second[j] == value) {
+      mask[j / 64] |= static_cast<uint64_t>(1) << (j % 64);
+    }
+  }
+  return mask;
+}
+
+//------------------------------------------------------------------------------
+// Restricts the analysis, and the folds, to the individuals of stratum
+//------------------------------------------------------------------------------
+void ExprsData::set_stratum(const std::string &stratum) {
+  stratum_mask = get_stratum_mask(stratum);
+  set_active(stratum_mask);
+}
+
+//------------------------------------------------------------------------------
+// Returns the individuals of fold 'fold' (1 to num_folds) of the current
+// stratum. The cases and the controls are each shuffled with FOLD_SEED and
+// dealt out to the folds in turn, so every fold gets its share of both and
+// the folds do not depend on the direction.
+//------------------------------------------------------------------------------
+std::vector<uint64_t> ExprsData::get_fold_mask(const std::size_t fold, const std::size_t num_folds) const {
+  assert(fold >= 1 && fold <= num_folds);
+  std::vector<uint64_t> mask(num_words, 0);
+  std::mt19937_64 rng(fold_seed);
+
+  const std::size_t ranges[2][2] = {{0, num_cases}, {num_cases, num_cases + num_ctrls}};
+  for (auto &r : ranges) {
+    std::vector<std::size_t> ids;
+    for (std::size_t j = r[0]; j < r[1]; ++j) {
+      if ((stratum_mask[j / 64] >> (j % 64)) & 1) {
+        ids.push_back(j);
+      }
+    }
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    for (std::size_t k = fold - 1; k < ids.size(); k += num_folds) {
+      mask[ids[k] / 64] |= static_cast<uint64_t>(1) << (ids[k] % 64);
+    }
+  }
+  return mask;
+}
+
+//------------------------------------------------------------------------------
+// Makes every individual of the stratum outside fold 'fold' active (the
+// training set of that fold), or the whole stratum if fold is 0
+//------------------------------------------------------------------------------
+void ExprsData::set_fold(const std::size_t fold, const std::size_t num_folds) {
+  std::vector<uint64_t> mask = stratum_mask;
+  if (fold > 0) {
+    const std::vector<uint64_t> held_out = get_fold_mask(fold, num_folds);
+    for (std::size_t w = 0; w < num_words; ++w) {
+      mask[w] &= ~held_out[w];
+    }
+  }
+  set_active(mask);
+}
+
+Numa::Policy ExprsData::get_numa_policy() const {
+  return numa_policy;
+}
+
+//------------------------------------------------------------------------------
+// Moves the bins to the placement of policy. none and pin keep them in
+// bin_data, where the reading thread first touched them.
+//------------------------------------------------------------------------------
+void ExprsData::set_numa_policy(const Numa::Policy policy) {
+  if (policy == Numa::NONE || policy == Numa::PIN) {
+    if (bin_data.empty()) {
+      bin_data.assign(bins, bins + num_stored_words);
+    }
+    placed_bins.clear();
+    bins = bin_data.data();
+  } else {
+    std::vector<std::shared_ptr<uint64_t>> placed = Numa::place(bins, num_stored_words, policy);
+    placed_bins.swap(placed);
+    std::vector<uint64_t>().swap(bin_data);
+    bins = placed_bins[0].get();
+  }
+  numa_policy = policy;
+}
+
 std::size_t ExprsData::get_grp1_start() const {
   return grp1_start;
 }
@@ -154,9 +499,136 @@ std::size_t ExprsData::get_grp2_stop() const {
 }
 
 bool ExprsData::get_bin(const std::size_t i, const std::size_t j) const {
-  assert(i < bin_data.size());
+  assert(i < num_bins_orig);
   assert(j < num_cases + num_ctrls);
-  return bin_data[i][j];
+  const uint64_t *words = get_stored_bins() + bin_offsets[i];
+  if (sparse_bins[i]) {
+    const uint32_t *indivs = reinterpret_cast<const uint32_t *>(words);
+    return std::binary_search(indivs, indivs + bin_sizes[i], static_cast<uint32_t>(j));
+  }
+  return (words[j / 64] >> (j % 64)) & 1;
+}
+
+std::size_t ExprsData::get_num_words() const {
+  return num_words;
+}
+
+const uint64_t * ExprsData::get_bin_words(const std::size_t i) const {
+  assert(i < num_bins_orig && !sparse_bins[i]);
+  return get_stored_bins() + bin_offsets[i];
+}
+
+bool ExprsData::is_sparse(const std::size_t i) const {
+  return sparse_bins[i];
+}
+
+//------------------------------------------------------------------------------
+// Number of individuals (active or not) with bin i
+//------------------------------------------------------------------------------
+std::size_t ExprsData::get_bin_size(const std::size_t i) const {
+  return bin_sizes[i];
+}
+
+//------------------------------------------------------------------------------
+// Sorted indices of the individuals with sparse bin i
+//------------------------------------------------------------------------------
+const uint32_t * ExprsData::get_bin_indivs(const std::size_t i) const {
+  assert(i < num_bins_orig && sparse_bins[i]);
+  return reinterpret_cast<const uint32_t *>(get_stored_bins() + bin_offsets[i]);
+}
+
+std::size_t ExprsData::get_num_sparse() const {
+  return std::count(sparse_bins.begin(), sparse_bins.end(), true);
+}
+
+//------------------------------------------------------------------------------
+// Removes the individuals without bin i from the packed set cover
+//------------------------------------------------------------------------------
+void ExprsData::and_bin(const std::size_t i, uint64_t *cover) const {
+  if (!sparse_bins[i]) {
+    const uint64_t *bin = get_bin_words(i);
+    for (std::size_t w = 0; w < num_words; ++w) {
+      cover[w] &= bin[w];
+    }
+    return;
+  }
+
+  const uint32_t *indivs = get_bin_indivs(i);
+  const uint32_t *stop = indivs + bin_sizes[i];
+  for (std::size_t w = 0; w < num_words; ++w) {
+    uint64_t bits = 0;
+    for (; indivs != stop && *indivs / 64 == w; ++indivs) {
+      bits |= static_cast<uint64_t>(1) << (*indivs % 64);
+    }
+    cover[w] &= bits;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of individuals with bin i in the packed set mask. A
+// sparse bin only tests the bits of its own individuals.
+//------------------------------------------------------------------------------
+std::size_t ExprsData::count_bin(const std::size_t i, const uint64_t *mask) const {
+  std::size_t count = 0;
+  if (sparse_bins[i]) {
+    const uint32_t *indivs = get_bin_indivs(i);
+    for (std::size_t k = 0; k < bin_sizes[i]; ++k) {
+      count += (mask[indivs[k] / 64] >> (indivs[k] % 64)) & 1;
+    }
+    return count;
+  }
+
+  const uint64_t *bin = get_bin_words(i);
+  for (std::size_t w = 0; w < num_words; ++w) {
+    count += utils::popcount(bin[w] & mask[w]);
+  }
+  return count;
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of individuals with bin i in both cover and mask
+//------------------------------------------------------------------------------
+std::size_t ExprsData::count_bin(const std::size_t i, const uint64_t *cover, const uint64_t *mask) const {
+  std::size_t count = 0;
+  if (sparse_bins[i]) {
+    const uint32_t *indivs = get_bin_indivs(i);
+    for (std::size_t k = 0; k < bin_sizes[i]; ++k) {
+      count += (cover[indivs[k] / 64] & mask[indivs[k] / 64]) >> (indivs[k] % 64) & 1;
+    }
+    return count;
+  }
+
+  const uint64_t *bin = get_bin_words(i);
+  for (std::size_t w = 0; w < num_words; ++w) {
+    count += utils::popcount(cover[w] & bin[w] & mask[w]);
+  }
+  return count;
+}
+
+//------------------------------------------------------------------------------
+// Bin storage of the calling thread's NUMA node
+//------------------------------------------------------------------------------
+const uint64_t * ExprsData::get_stored_bins() const {
+  if (numa_policy == Numa::REPLICATE) {
+    return placed_bins[Numa::get_node()].get();
+  }
+  return bins;
+}
+
+const std::vector<uint64_t> & ExprsData::get_grp1_mask() const {
+  return grp1_mask;
+}
+
+const std::vector<uint64_t> & ExprsData::get_grp2_mask() const {
+  return grp2_mask;
+}
+
+const std::vector<std::size_t> & ExprsData::get_grp1_indivs() const {
+  return grp1_indivs;
+}
+
+const std::vector<std::size_t> & ExprsData::get_grp2_indivs() const {
+  return grp2_indivs;
 }
 
 void ExprsData::print_bin_data(const std::string &file_name) const {
@@ -167,9 +639,9 @@ void ExprsData::print_bin_data(const std::string &file_name) const {
     exit(EXIT_FAILURE);
   }
 
-  for (std::size_t i = 0; i < bin_data.size(); ++i) {
+  for (std::size_t i = 0; i < num_bins_orig; ++i) {
     for (std::size_t j = 0; j < num_cases + num_ctrls; ++j) {
-      fprintf(output, bin_data[i][j] ? "1 " : "0 ");
+      fprintf(output, get_bin(i, j) ? "1 " : "0 ");
     }
     fprintf(output, "\n");
   }
@@ -182,7 +654,7 @@ std::size_t ExprsData::get_orig_index(const std::size_t idx) const {
   return reduced_to_orig[idx];
 }
 
-std::string ExprsData::get_pat_as_str(const std::vector<std::size_t> &pat) const {
+std::string ExprsData::get_pat_as_str(const Pattern &pat) const {
   std::ostringstream oss;   
   std::size_t orig_idx, index;
   std::string bin, val;
@@ -210,8 +682,8 @@ std::string ExprsData::get_pat_as_str(const std::vector<std::size_t> &pat) const
   return oss.str();
 }
 
-bool ExprsData::indiv_has_pat(const std::size_t ind, const std::vector<std::size_t> &pat) const {
-  if (ind >= grp1_total + grp2_total) {
+bool ExprsData::indiv_has_pat(const std::size_t ind, const Pattern &pat) const {
+  if (ind >= num_cases + num_ctrls) {
     fprintf(stderr, "ERROR - ExprsData::indiv_has_pat - Trying to access indivual at index %lu\n", ind);
     exit(1);
   }
@@ -224,24 +696,36 @@ bool ExprsData::indiv_has_pat(const std::size_t ind, const std::vector<std::size
   return true;
 }
 
-double ExprsData::get_grp1_freq(const std::vector<std::size_t> &pat) const {
-  double f1 = 0.0;
+double ExprsData::get_grp1_freq(const Pattern &pat) const {
+  std::vector<uint64_t> cover;
+  get_cover(pat, cover);
+  return static_cast<double>(count_in_mask(cover, grp1_mask)) / grp1_total;
+}
 
-  for (std::size_t ind = grp1_start; ind <= grp1_stop; ++ind) {
-    if (indiv_has_pat(ind, pat)) {
-      ++f1;
-    }
-  }
-  return f1 / grp1_total;
+double ExprsData::get_grp2_freq(const Pattern &pat) const {
+  std::vector<uint64_t> cover;
+  get_cover(pat, cover);
+  return static_cast<double>(count_in_mask(cover, grp2_mask)) / grp2_total;
 }
 
-double ExprsData::get_grp2_freq(const std::vector<std::size_t> &pat) const {
-  double f2 = 0.0;
+//------------------------------------------------------------------------------
+// Sets cover to the packed set of individuals that have every bin in pat
+//------------------------------------------------------------------------------
+void ExprsData::get_cover(const Pattern &pat, std::vector<uint64_t> &cover) const {
+  cover.assign(num_words, ~static_cast<uint64_t>(0));
 
-  for (std::size_t ind = grp2_start; ind <= grp2_stop; ++ind) {
-    if (indiv_has_pat(ind, pat)) {
-      ++f2;
-    }
+  for (auto p : pat) {
+    and_bin(p, cover.data());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of individuals in both cover and mask
+//------------------------------------------------------------------------------
+std::size_t ExprsData::count_in_mask(const std::vector<uint64_t> &cover, const std::vector<uint64_t> &mask) const {
+  std::size_t count = 0;
+  for (std::size_t w = 0; w < num_words; ++w) {
+    count += utils::popcount(cover[w] & mask[w]);
   }
-  return f2 / grp2_total;
+  return count;
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 #ifndef EXPRS_DATA_H
 #define EXPRS_DATA_H
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 #include "ConfigParser.h"
+#include "Numa.h"
+#include "Pattern.h"
 
 class ExprsData {
   private:
@@ -14,14 +20,15 @@ class ExprsData {
     const std::size_t num_header_rows;
     const std::size_t num_header_cols;
         
-    const bool risk;
-    const std::size_t grp1_total;
-    const std::size_t grp1_start;
-    const std::size_t grp1_stop;
-    const std::size_t grp2_total;
-    const std::size_t grp2_start;
-    const std::size_t grp2_stop;
+    bool risk;
+    std::size_t grp1_total;
+    std::size_t grp1_start;
+    std::size_t grp1_stop;
+    std::size_t grp2_total;
+    std::size_t grp2_start;
+    std::size_t grp2_stop;
     const std::size_t num_bins_orig;
+    const std::size_t num_words;
     
     const std::string data_file;
     const std::string MISSING_SYMBOL;
@@ -29,17 +36,57 @@ class ExprsData {
     const std::string HIGH_BIN;
     const std::string NORM_BIN;
     const std::string LOW_BIN;
+    const uint64_t fold_seed;
+    const std::string annotation_file;
 
-    std::vector<std::vector<bool>> bin_data;
+    const double sparse_density;
+
+    // Bins are stored one after the other from word bin_offsets[i]. A dense
+    // bin packs 64 individuals per word over num_words words. A sparse bin,
+    // set for at most SPARSE_DENSITY of the individuals, holds the sorted
+    // uint32 indices of its bin_sizes[i] individuals, two per word.
+    std::vector<uint64_t> bin_data;
+    std::vector<std::size_t> bin_offsets;
+    std::vector<std::size_t> bin_sizes;
+    std::vector<bool> sparse_bins;
+    // Under a NUMA_POLICY other than none and pin, bin_data is released and
+    // the bins live in placed_bins instead: one copy per node for replicate,
+    // a single interleaved copy otherwise. bins points to the copy of node 0.
+    Numa::Policy numa_policy;
+    std::vector<std::shared_ptr<uint64_t>> placed_bins;
+    const uint64_t *bins;
+    std::size_t num_stored_words;
+    // Individual IDs from the first header row and, for each column of the
+    // annotation file, the value of every individual ("" if not annotated)
+    std::vector<std::string> indiv_names;
+    std::map<std::string, std::vector<std::string>> annotations;
+    // Individuals of the current stratum (all by default); folds split them
+    std::vector<uint64_t> stratum_mask;
+    // Individuals taking part in the analysis (all by default); the group
+    // masks and lists only hold active individuals
+    std::vector<uint64_t> active_mask;
+    std::vector<uint64_t> grp1_mask;
+    std::vector<uint64_t> grp2_mask;
+    std::vector<std::size_t> grp1_indivs;
+    std::vector<std::size_t> grp2_indivs;
     std::vector<std::pair<std::size_t, std::vector<std::size_t>>> dups;
     std::vector<std::size_t> reduced_to_orig;
         
     void read_bin_data();
+    void read_bins(const std::function<void(const uint64_t *)> &use_bin);
+    std::size_t get_stored_words(const uint64_t *words) const;
+    void read_annotations();
+    void check_strata(const ConfigParser &parser) const;
+    void store_bin(const uint64_t *words);
+    const uint64_t * get_stored_bins() const;
+    void build_group_masks();
 
   public:
     std::vector<std::string> analyte_names;
 
     ExprsData(const ConfigParser &parser);
+    ExprsData(const ExprsData &) = delete;
+    ExprsData & operator=(const ExprsData &) = delete;
     ~ExprsData();
     const char * get_analyte_name(const std::size_t index) const;
 
@@ -47,21 +94,46 @@ class ExprsData {
     std::size_t get_num_grp2() const;
     std::size_t get_num_bins() const;
     bool get_risk() const;
+    void set_risk(const bool _risk);
+    void set_active(const std::vector<uint64_t> &mask);
+    std::vector<uint64_t> get_all_mask() const;
+    std::vector<uint64_t> get_stratum_mask(const std::string &stratum) const;
+    void set_stratum(const std::string &stratum);
+    std::vector<uint64_t> get_fold_mask(const std::size_t fold, const std::size_t num_folds) const;
+    void set_fold(const std::size_t fold, const std::size_t num_folds);
+    Numa::Policy get_numa_policy() const;
+    void set_numa_policy(const Numa::Policy policy);
     std::size_t get_grp1_start() const;
     std::size_t get_grp1_stop() const;
     std::size_t get_grp2_start() const;
     std::size_t get_grp2_stop() const;
     bool get_bin(const std::size_t i, const std::size_t j) const;
+    std::size_t get_num_words() const;
+    const uint64_t * get_bin_words(const std::size_t i) const;
+    bool is_sparse(const std::size_t i) const;
+    std::size_t get_bin_size(const std::size_t i) const;
+    const uint32_t * get_bin_indivs(const std::size_t i) const;
+    std::size_t get_num_sparse() const;
+    void and_bin(const std::size_t i, uint64_t *cover) const;
+    std::size_t count_bin(const std::size_t i, const uint64_t *mask) const;
+    std::size_t count_bin(const std::size_t i, const uint64_t *cover, const uint64_t *mask) const;
+    const std::vector<uint64_t> & get_grp1_mask() const;
+    const std::vector<uint64_t> & get_grp2_mask() const;
+    const std::vector<std::size_t> & get_grp1_indivs() const;
+    const std::vector<std::size_t> & get_grp2_indivs() const;
 
     void print_bin_data(const std::string &file_name) const;
     std::size_t get_orig_index(const std::size_t idx) const;
 
-    std::string get_pat_as_str(const std::vector<std::size_t> &pat) const;
+    std::string get_pat_as_str(const Pattern &pat) const;
+
+    double get_grp1_freq(const Pattern &pat) const;
+    double get_grp2_freq(const Pattern &pat) const;
 
-    double get_grp1_freq(const std::vector<std::size_t> &pat) const;
-    double get_grp2_freq(const std::vector<std::size_t> &pat) const;
+    void get_cover(const Pattern &pat, std::vector<uint64_t> &cover) const;
+    std::size_t count_in_mask(const std::vector<uint64_t> &cover, const std::vector<uint64_t> &mask) const;
 
-    bool indiv_has_pat(const std::size_t ind, const std::vector<std::size_t> &pat) const;
+    bool indiv_has_pat(const std::size_t ind, const Pattern &pat) const;
 };
 
 #endif
\ No newline at end of file
@@ -1,19 +1,98 @@
 #include "GreedyController.h"
 
 #include "Parallel.h"
-#include <experimental/filesystem>
+#include "Checkpoint.h"
+#include "PatternScorer.h"
+#include "PoolReduce.h"
+#include "Utils.h"
+#include "WorkQueue.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+namespace {
+  // Copies from to to if from exists
+  void copy_file(const std::string &from, const std::string &to) {
+    std::ifstream input(from, std::ios_base::binary);
+    if (input.is_open()) {
+      std::ofstream output(to, std::ios_base::binary);
+      output << input.rdbuf();
+    }
+  }
+}
 
 GreedyController::GreedyController(const ConfigParser &_parser) : parser(&_parser),
                                                                   data(*parser),
                                                                   world_size(Parallel::get_world_size()),
-                                                                  scratch_dir(parser->getString("SCRATCH_DIR")),
-                                                                  min_obj(parser->getDouble("MIN_OBJ")),
+                                                                  runs(Run::list(*parser)),
+                                                                  run_index(0),
+                                                                  scratch_dir(runs[0].scratch_dir),
+                                                                  min_obj(runs[0].min_obj),
+                                                                  config_hash(Checkpoint::hash_config(*parser)),
+                                                                  ps2_schedule(parser->hasParameter("PS2_SCHEDULE") ?
+                                                                               parser->getString("PS2_SCHEDULE") : "cost"),
+                                                                  scheduler(parser->hasParameter("SCHEDULER") ?
+                                                                            parser->getString("SCHEDULER") : "central"),
+                                                                  worker_pools(parser->hasParameter("WORKER_POOLS") &&
+                                                                               parser->getBool("WORKER_POOLS")),
+                                                                  screen_fraction(parser->hasParameter("SCREEN_FRACTION") ?
+                                                                                  parser->getDouble("SCREEN_FRACTION") : 1.0),
+                                                                  screen_error(parser->hasParameter("SCREEN_ERROR") ?
+                                                                               parser->getDouble("SCREEN_ERROR") : 0.001),
+                                                                  stop_no_improvement(parser->hasParameter("STOP_NO_IMPROVEMENT") ?
+                                                                                      parser->getSizeT("STOP_NO_IMPROVEMENT") : 0),
+                                                                  stop_min_gain(parser->hasParameter("STOP_MIN_GAIN") ?
+                                                                                parser->getDouble("STOP_MIN_GAIN") : 0.0),
+                                                                  stop_below_min_obj(parser->hasParameter("STOP_BELOW_MIN_OBJ") &&
+                                                                                     parser->getBool("STOP_BELOW_MIN_OBJ")),
+                                                                  stop_pool_fraction(parser->hasParameter("STOP_POOL_FRACTION") ?
+                                                                                     parser->getDouble("STOP_POOL_FRACTION") : 0.0),
                                                                   ps(0),
-                                                                  pool1(parser->getSizeT("SOL_POOL_SIZE")),
-                                                                  pool2(parser->getSizeT("SOL_POOL_SIZE")),
+                                                                  exact(false),
+                                                                  level_start(0.0),
+                                                                  level_trace_start(0.0),
+                                                                  pool1(runs[0].sol_pool_size),
+                                                                  pool2(runs[0].sol_pool_size),
                                                                   cur_pool(&pool1),
                                                                   old_pool(&pool2),
-                                                                  lb(min_obj) {
+                                                                  lb(min_obj),
+                                                                  mirror_index(runs.size()),
+                                                                  mirror(false),
+                                                                  mirror_pool(runs[0].sol_pool_size),
+                                                                  mirror_lb(0.0),
+                                                                  pool_format(PoolWriter::parse_format(
+                                                                    parser->hasParameter("POOL_FORMAT") ?
+                                                                    parser->getString("POOL_FORMAT") : "text")),
+                                                                  tracer(*parser) {
+  Run::make_dirs(*parser, runs);
+  if (ps2_schedule != "cost" && ps2_schedule != "ordered") {
+    throw std::runtime_error("GreedyController: Unknown PS2_SCHEDULE '" + ps2_schedule + "'");
+  }
+  for (auto &run : runs) {
+    if (run.max_ps > Pattern::max_size()) {
+      throw std::runtime_error("GreedyController: MAX_PS is larger than MAX_PATTERN_SIZE (" +
+                               std::to_string(Pattern::max_size()) + "); rebuild with -DMAX_PATTERN_SIZE=N");
+    }
+  }
+
+  for (auto &direction : level_cache) {
+    for (auto &cache : direction) {
+      cache.valid = false;
+    }
+  }
+  if (scheduler != "central" && scheduler != "distributed") {
+    throw std::runtime_error("GreedyController: Unknown SCHEDULER '" + scheduler + "'");
+  }
+  if (!(screen_fraction > 0.0 && screen_fraction <= 1.0)) {
+    throw std::runtime_error("GreedyController: SCREEN_FRACTION must be in (0, 1]");
+  }
+  if (!(screen_error > 0.0 && screen_error < 1.0)) {
+    throw std::runtime_error("GreedyController: SCREEN_ERROR must be in (0, 1)");
+  }
+  if (!(stop_pool_fraction >= 0.0 && stop_pool_fraction <= 1.0)) {
+    throw std::runtime_error("GreedyController: STOP_POOL_FRACTION must be in [0, 1]");
+  }
+
   for (std::size_t i = 1; i < world_size; ++i) {
     available_workers.push(i);
   }
@@ -25,11 +104,21 @@ void GreedyController::send_ps1_problem(const std::size_t start, const std::size
   // Get next worker
   const int worker = available_workers.top();
 
+  const double trace_start = tracer.now();
+  counters.start_mpi();
+
   // Send start and stop marker values
-  MPI_Send(&start, 1, MPI_INT, worker, Parallel::PS1_TAG, MPI_COMM_WORLD);
-  MPI_Send(&stop, 1, MPI_INT, worker, Parallel::PS1_TAG, MPI_COMM_WORLD);
+  MPI_Send(&start, 1, CUSTOM_SIZE_T, worker, Parallel::PS1_TAG, MPI_COMM_WORLD);
+  MPI_Send(&stop, 1, CUSTOM_SIZE_T, worker, Parallel::PS1_TAG, MPI_COMM_WORLD);
 
   MPI_Send(&min_obj, 1, MPI_DOUBLE, worker, Parallel::PS1_TAG, MPI_COMM_WORLD);
+  send_mirror(worker, Parallel::PS1_TAG);
+
+  counters.stop_mpi();
+  counters.count_sent(2, CUSTOM_SIZE_T);
+  counters.count_sent(1, MPI_DOUBLE);
+  counters.add(PerfCounters::TASKS);
+  tracer.record(Tracer::DISPATCH, trace_start, worker);
 
   // Make worker unavailable
   available_workers.pop();
@@ -44,18 +133,43 @@ void GreedyController::send_ps2_problem(const std::size_t marker) {
   // Get next worker
   const int worker = available_workers.top();
 
+  const double trace_start = tracer.now();
+  counters.start_mpi();
+
   // Send marker
-  MPI_Send(&marker, 1, MPI_INT, worker, Parallel::PS2_TAG, MPI_COMM_WORLD);
+  MPI_Send(&marker, 1, CUSTOM_SIZE_T, worker, Parallel::PS2_TAG, MPI_COMM_WORLD);
 
   // Send min_obj
   MPI_Send(&lb, 1, MPI_DOUBLE, worker, Parallel::PS2_TAG, MPI_COMM_WORLD);
+  send_mirror(worker, Parallel::PS2_TAG);
+
+  counters.stop_mpi();
+  counters.count_sent(1, CUSTOM_SIZE_T);
+  counters.count_sent(1, MPI_DOUBLE);
+  counters.add(PerfCounters::TASKS);
+  tracer.record(Tracer::DISPATCH, trace_start, worker);
 
   // Make worker unavailable
   available_workers.pop();
   unavailable_workers.insert(worker);
 }
 
-void GreedyController::send_problem(const std::vector<std::size_t> &sol) {
+//------------------------------------------------------------------------------
+// Tells the worker whether the PS1 or PS2 task also fills the mirror pool and,
+// if so, the lower bound of the mirror pool
+//------------------------------------------------------------------------------
+void GreedyController::send_mirror(const int worker, const int tag) {
+  const char signal = mirror ? 1 : 0;
+  MPI_Send(&signal, 1, MPI_CHAR, worker, tag, MPI_COMM_WORLD);
+  counters.count_sent(1, MPI_CHAR);
+
+  if (mirror) {
+    MPI_Send(&mirror_lb, 1, MPI_DOUBLE, worker, tag, MPI_COMM_WORLD);
+    counters.count_sent(1, MPI_DOUBLE);
+  }
+}
+
+void GreedyController::send_problem(const std::vector<Pattern> &parents) {
   while (available_workers.empty()) {
     receive_completion();
   }
@@ -63,16 +177,157 @@ void GreedyController::send_problem(const std::vector<std::size_t> &sol) {
   // Get next worker
   const int worker = available_workers.top();
 
-  // Send number of markers in solution
-  const std::size_t sol_size = sol.size();
-  MPI_Send(&sol_size, 1, CUSTOM_SIZE_T, worker, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
+  const double trace_start = tracer.now();
+  counters.start_mpi();
 
-  // Send solution
-  MPI_Send(&sol[0], sol_size, CUSTOM_SIZE_T, worker, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
+  // Send number of parents and markers per parent
+  const std::size_t header[2] = {parents.size(), ps - 1};
+  MPI_Send(header, 2, CUSTOM_SIZE_T, worker, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
+
+  // Send parents
+  std::vector<uint32_t> pats;
+  pats.reserve(header[0] * header[1]);
+  for (auto &p : parents) {
+    pats.insert(pats.end(), p.begin(), p.end());
+  }
+  MPI_Send(pats.data(), pats.size(), MPI_UINT32_T, worker, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
 
   // Send lower bound
   MPI_Send(&lb, 1, MPI_DOUBLE, worker, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
 
+  counters.stop_mpi();
+  counters.count_sent(2, CUSTOM_SIZE_T);
+  counters.count_sent(pats.size(), MPI_UINT32_T);
+  counters.count_sent(1, MPI_DOUBLE);
+  counters.add(PerfCounters::TASKS);
+  tracer.record(Tracer::DISPATCH, trace_start, worker);
+
+  // Make worker unavailable
+  available_workers.pop();
+  unavailable_workers.insert(worker);
+}
+
+//------------------------------------------------------------------------------
+// Broadcasts every pattern of old_pool, sorted by bin, to the workers, which
+// split them into per-rank ranges and steal from each other through a
+// WorkQueue. Each range is then a run of neighbouring subtrees of the prefix
+// trie. Returns once every worker has run out of work.
+//------------------------------------------------------------------------------
+void GreedyController::distribute_problems() {
+  const double trace_start = tracer.now();
+  counters.start_mpi();
+
+  char signal = 0;
+  for (std::size_t i = 1; i < world_size; ++i) {
+    MPI_Send(&signal, 1, MPI_CHAR, i, Parallel::DISTRIBUTED_TAG, MPI_COMM_WORLD);
+  }
+
+  std::vector<Pattern> parents;
+  for (auto &s : old_pool->get_solutions()) {
+    parents.push_back(s.pat);
+  }
+  std::sort(parents.begin(), parents.end());
+
+  std::size_t header[2] = {parents.size(), ps - 1};
+  std::vector<uint32_t> pats;
+  pats.reserve(header[0] * header[1]);
+  for (auto &p : parents) {
+    pats.insert(pats.end(), p.begin(), p.end());
+  }
+
+  MPI_Bcast(header, 2, CUSTOM_SIZE_T, 0, MPI_COMM_WORLD);
+  MPI_Bcast(pats.data(), pats.size(), MPI_UINT32_T, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&lb, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  counters.count_sent(world_size - 1, MPI_CHAR);
+  counters.count_sent(2, CUSTOM_SIZE_T);
+  counters.count_sent(pats.size(), MPI_UINT32_T);
+  counters.count_sent(1, MPI_DOUBLE);
+  tracer.record(Tracer::DISPATCH, trace_start, header[0]);
+
+  WorkQueue::release_workers();
+  counters.stop_mpi();
+}
+
+//------------------------------------------------------------------------------
+// Receives the pools of all workers merged by a tree reduction and makes them
+// the pool of the level, followed by the mirror pool if the level has one
+//------------------------------------------------------------------------------
+void GreedyController::reduce_pools() {
+  double trace_start = tracer.now();
+  counters.start_mpi();
+
+  const std::vector<Solution> sols = PoolReduce::reduce(std::vector<Solution>(), ps, cur_pool->get_max_size(), 0);
+  counters.count_recv(PoolReduce::get_buffer_size(ps, cur_pool->get_max_size()), MPI_BYTE);
+
+  std::vector<Solution> mirror_sols;
+  if (mirror) {
+    mirror_sols = PoolReduce::reduce(std::vector<Solution>(), ps, mirror_pool.get_max_size(), 0);
+    counters.count_recv(PoolReduce::get_buffer_size(ps, mirror_pool.get_max_size()), MPI_BYTE);
+  }
+
+  counters.stop_mpi();
+  tracer.record(Tracer::RECEIVE, trace_start, sols.size());
+
+  trace_start = tracer.now();
+  counters.start_compute();
+
+  cur_pool->set_solutions(sols);
+  counters.add(PerfCounters::POOL_INSERTS, sols.size());
+  if (cur_pool->size() == cur_pool->get_max_size() && cur_pool->get_min_obj() > lb) {
+    lb = cur_pool->get_min_obj();
+  }
+  if (mirror) {
+    mirror_pool.set_solutions(mirror_sols);
+    counters.add(PerfCounters::POOL_INSERTS, mirror_sols.size());
+  }
+
+  counters.stop_compute();
+  tracer.record(Tracer::MERGE, trace_start, sols.size());
+}
+
+//------------------------------------------------------------------------------
+// Ends a level run with worker pools: every worker contributes its pool to
+// the tree reduction and then clears it for the next level
+//------------------------------------------------------------------------------
+void GreedyController::flush_worker_pools() {
+  const double trace_start = tracer.now();
+  counters.start_mpi();
+
+  const std::size_t header[2] = {ps, mirror ? 1u : 0u};
+  for (std::size_t i = 1; i < world_size; ++i) {
+    MPI_Send(header, 2, CUSTOM_SIZE_T, i, Parallel::FLUSH_TAG, MPI_COMM_WORLD);
+  }
+
+  counters.stop_mpi();
+  counters.count_sent(2 * (world_size - 1), CUSTOM_SIZE_T);
+  tracer.record(Tracer::DISPATCH, trace_start, 0);
+
+  reduce_pools();
+}
+
+void GreedyController::send_exact_problem(const std::size_t first_bin) {
+  while (available_workers.empty()) {
+    receive_completion();
+  }
+
+  // Get next worker
+  const int worker = available_workers.top();
+
+  const double trace_start = tracer.now();
+  counters.start_mpi();
+
+  // Send first bin, pattern size and lower bound
+  MPI_Send(&first_bin, 1, CUSTOM_SIZE_T, worker, Parallel::EXACT_TAG, MPI_COMM_WORLD);
+  MPI_Send(&ps, 1, CUSTOM_SIZE_T, worker, Parallel::EXACT_TAG, MPI_COMM_WORLD);
+  MPI_Send(&lb, 1, MPI_DOUBLE, worker, Parallel::EXACT_TAG, MPI_COMM_WORLD);
+
+  counters.stop_mpi();
+  counters.count_sent(2, CUSTOM_SIZE_T);
+  counters.count_sent(1, MPI_DOUBLE);
+  counters.add(PerfCounters::TASKS);
+  tracer.record(Tracer::DISPATCH, trace_start, worker);
+
   // Make worker unavailable
   available_workers.pop();
   unavailable_workers.insert(worker);
@@ -83,39 +338,112 @@ void GreedyController::receive_completion() {
 
   MPI_Status status;
 
+  double trace_start = tracer.now();
+  counters.start_mpi();
   MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+  tracer.record(Tracer::WAIT, trace_start, status.MPI_SOURCE);
+  trace_start = tracer.now();
+
+  // With worker pools the worker only reports its pruning thresholds, which
+  // are valid lower bounds for the level once its own pools are full
+  if (worker_pools) {
+    double thresholds[2];
+    MPI_Recv(thresholds, mirror ? 2 : 1, MPI_DOUBLE, status.MPI_SOURCE, Parallel::GREEDY_TAG, MPI_COMM_WORLD,
+             MPI_STATUS_IGNORE);
+    counters.stop_mpi();
+    counters.count_recv(mirror ? 2 : 1, MPI_DOUBLE);
+    tracer.record(Tracer::RECEIVE, trace_start, 0);
+
+    if (thresholds[0] > lb) {
+      lb = thresholds[0];
+    }
+    if (mirror && thresholds[1] > mirror_lb) {
+      mirror_lb = thresholds[1];
+    }
+
+    available_workers.push(status.MPI_SOURCE);
+    unavailable_workers.erase(status.MPI_SOURCE);
+    return;
+  }
+
+  const std::vector<Solution> sols = receive_solutions(status.MPI_SOURCE);
+  std::vector<Solution> mirror_sols;
+  if (mirror) {
+    mirror_sols = receive_solutions(status.MPI_SOURCE);
+  }
+
+  counters.stop_mpi();
+  tracer.record(Tracer::RECEIVE, trace_start, sols.size() + mirror_sols.size());
+
+  // Merge the solutions into the pool
+  trace_start = tracer.now();
+  counters.start_compute();
+
+  merge_solutions(sols, *cur_pool, lb);
+  merge_solutions(mirror_sols, mirror_pool, mirror_lb);
 
+  counters.stop_compute();
+  tracer.record(Tracer::MERGE, trace_start, sols.size() + mirror_sols.size());
+
+  available_workers.push(status.MPI_SOURCE);
+  unavailable_workers.erase(status.MPI_SOURCE);
+}
+
+//------------------------------------------------------------------------------
+// Receives one pool of solutions of size ps from worker
+//------------------------------------------------------------------------------
+std::vector<Solution> GreedyController::receive_solutions(const int worker) {
   std::size_t num_sols;
-  std::vector<std::size_t> sol(ps);
-  double obj_value;
+  double vals[3];
 
   // Receive number of solutions in pool
-  MPI_Recv(&num_sols, 1, CUSTOM_SIZE_T, status.MPI_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);  
+  MPI_Recv(&num_sols, 1, CUSTOM_SIZE_T, worker, MPI_ANY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
+  std::vector<Solution> sols(num_sols);
   for (std::size_t i = 0; i < num_sols; ++i) {
+    sols[i].pat.resize(ps);
+
     // Receive markes in solution
-    MPI_Recv(&sol[0], ps, CUSTOM_SIZE_T, status.MPI_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Recv(&sols[i].pat[0], ps, MPI_UINT32_T, worker, MPI_ANY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    // Receive solution obj, f1 and f2 values
+    MPI_Recv(vals, 3, MPI_DOUBLE, worker, MPI_ANY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    sols[i].obj = vals[0];
+    sols[i].f1 = vals[1];
+    sols[i].f2 = vals[2];
+  }
 
-    // Receive solution objective value
-    MPI_Recv(&obj_value, 1, MPI_DOUBLE, status.MPI_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  counters.count_recv(1, CUSTOM_SIZE_T);
+  counters.count_recv(num_sols * ps, MPI_UINT32_T);
+  counters.count_recv(3 * num_sols, MPI_DOUBLE);
+  return sols;
+}
 
-    cur_pool->add_solution(obj_value, sol);
+//------------------------------------------------------------------------------
+// Adds sols to pool and raises bound to the worst solution of pool once it is
+// full
+//------------------------------------------------------------------------------
+void GreedyController::merge_solutions(const std::vector<Solution> &sols, SolPool &pool, double &bound) {
+  for (auto &s : sols) {
+    if (pool.add_solution(s)) {
+      counters.add(PerfCounters::POOL_INSERTS);
+    } else {
+      counters.add(PerfCounters::POOL_REJECTS);
+    }
 
-    if (cur_pool->size() == cur_pool->get_max_size() && cur_pool->get_min_obj() > lb) {
-      lb = cur_pool->get_min_obj();
+    if (pool.size() == pool.get_max_size() && pool.get_min_obj() > bound) {
+      bound = pool.get_min_obj();
     }
   }
-
-  available_workers.push(status.MPI_SOURCE);
-  unavailable_workers.erase(status.MPI_SOURCE);
 }
 
-void GreedyController::combine_marker_pair_files() {
-  std::string file_name = scratch_dir + "markerPairs.csv";
+void GreedyController::combine_marker_pair_files(const std::string &dir) {
+  std::string file_name = dir + "markerPairs.csv";
   std::ofstream output(file_name, std::ios_base::binary);
 
   for (std::size_t p = 1; p < world_size; ++p) {
-    std::string input_file = scratch_dir + "markerPairs_part" + std::to_string(p) + ".csv";
+    std::string input_file = dir + "markerPairs_part" + std::to_string(p) + ".csv";
     std::ifstream input(input_file.c_str(), std::ios_base::binary);
     output << input.rdbuf();
 
@@ -123,13 +451,435 @@ void GreedyController::combine_marker_pair_files() {
   }
 }
 
+//------------------------------------------------------------------------------
+// Removes partial pair count files in dir left behind by an interrupted run
+//------------------------------------------------------------------------------
+void GreedyController::remove_marker_pair_files(const std::string &dir) const {
+  for (std::size_t p = 1; p < world_size; ++p) {
+    std::string input_file = dir + "markerPairs_part" + std::to_string(p) + ".csv";
+    remove(input_file.c_str());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Base name of the output files of the current level: ps# for the greedy
+// levels and ps#.exact for an exact search
+//------------------------------------------------------------------------------
+std::string GreedyController::get_level_name() const {
+  return "ps" + std::to_string(ps) + (exact ? ".exact" : "");
+}
+
+//------------------------------------------------------------------------------
+// Queues the current pool and a checkpoint of the completed level to be
+// written in the background so the next level can be dispatched right away.
+// An exact search does not touch the checkpoint of the greedy levels.
+//------------------------------------------------------------------------------
+void GreedyController::save_level() {
+  std::string file_name = scratch_dir + get_level_name() + ".solPool";
+  const std::vector<Solution> sols = cur_pool->get_solutions();
+  writer.write(file_name, sols, pool_format);
+
+  if (exact) {
+    return;
+  }
+
+  if (runs[run_index].fold > 0) {
+    score_held_out(sols);
+  }
+
+  count_cache.levels.resize(ps);
+  CountCache::Level &level = count_cache.levels[ps - 1];
+  level.min_obj = min_obj;
+  level.max_size = cur_pool->get_max_size();
+  level.exact = true;
+  level.sols = sols;
+
+  // A run a stopping rule ends counts as complete when resumed
+  stop_reason = check_stop();
+
+  Checkpoint checkpoint;
+  checkpoint.config_hash = config_hash;
+  checkpoint.ps = ps;
+  checkpoint.lb = lb;
+  checkpoint.stopped = !stop_reason.empty();
+  checkpoint.sols = sols;
+  writer.write_checkpoint(Checkpoint::file_name(scratch_dir), checkpoint);
+  writer.write_counts(CountCache::file_name(scratch_dir), count_cache);
+}
+
+//------------------------------------------------------------------------------
+// Evaluates the stopping rules on the pools of the levels completed so far and
+// returns why the run should end after the current level, or an empty string
+// to go on. Runs already at MAX_PS are never stopped.
+//------------------------------------------------------------------------------
+std::string GreedyController::check_stop() const {
+  if (ps >= runs[run_index].max_ps) {
+    return "";
+  }
+
+  std::vector<double> max_objs;
+  for (auto &l : count_cache.levels) {
+    double max_obj = -1.0;
+    for (auto &s : l.sols) {
+      max_obj = std::max(max_obj, s.obj);
+    }
+    max_objs.push_back(max_obj);
+  }
+
+  if (stop_no_improvement > 0 && ps > stop_no_improvement) {
+    const std::size_t first = ps - stop_no_improvement;
+    const double best = *std::max_element(max_objs.begin(), max_objs.begin() + first);
+    if (*std::max_element(max_objs.begin() + first, max_objs.end()) <= best + stop_min_gain) {
+      return "max obj has not improved on " + std::to_string(best) + " for " +
+             std::to_string(stop_no_improvement) + " level(s)";
+    }
+  }
+
+  // The beam counts only solutions that passed the obj gate, not the PS2
+  // pairs pooled on f1 alone. Its edge is at MIN_OBJ once it cannot be filled
+  // with them, or its worst one is at MIN_OBJ; the run has plateaued there if
+  // the beam also holds no more of them than the level before.
+  const std::vector<Solution> &sols = count_cache.levels[ps - 1].sols;
+  if (stop_below_min_obj && ps >= 2) {
+    auto count_passed = [this](const std::vector<Solution> &level_sols, double &edge) {
+      std::size_t count = 0;
+      edge = std::numeric_limits<double>::infinity();
+      for (auto &s : level_sols) {
+        if (s.obj >= min_obj) {
+          ++count;
+          edge = std::min(edge, s.obj);
+        }
+      }
+      return count;
+    };
+
+    double edge, prev_edge;
+    const std::size_t num_passed = count_passed(sols, edge);
+    const std::size_t num_prev = count_passed(count_cache.levels[ps - 2].sols, prev_edge);
+    if ((num_passed < cur_pool->get_max_size() || edge <= min_obj) && num_passed <= num_prev) {
+      return "the edge of the pool has reached MIN_OBJ with " + std::to_string(num_passed) + " of " +
+             std::to_string(cur_pool->get_max_size()) + " solutions reaching it, after " +
+             std::to_string(num_prev) + " at PS" + std::to_string(ps - 1);
+    }
+  }
+
+  if (sols.size() < stop_pool_fraction * cur_pool->get_max_size()) {
+    return "the pool holds " + std::to_string(sols.size()) + " of " +
+           std::to_string(cur_pool->get_max_size()) + " solutions";
+  }
+  return "";
+}
+
+const std::string & GreedyController::get_stop_reason() const {
+  return stop_reason;
+}
+
+//------------------------------------------------------------------------------
+// Scores the level's solutions, found on the training individuals of the
+// current fold, on the individuals held out of it and writes them to
+// ps#.heldout.tsv in the order of the pool
+//------------------------------------------------------------------------------
+void GreedyController::score_held_out(const std::vector<Solution> &sols) {
+  const Run &run = runs[run_index];
+  std::vector<Pattern> pats;
+  for (auto &s : sols) {
+    pats.push_back(s.pat);
+  }
+
+  data.set_active(data.get_fold_mask(run.fold, run.num_folds));
+  const std::vector<Solution> held_out = PatternScorer(data, 1).score(pats);
+
+  const std::string file_name = scratch_dir + get_level_name() + ".heldout.tsv";
+  FILE *output = fopen(file_name.c_str(), "w");
+  if (output == NULL) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
+    exit(1);
+  }
+
+  double best = -std::numeric_limits<double>::infinity(), total = 0.0;
+  fprintf(output, "train_obj\ttest_obj\ttest_f1\ttest_f2\tpattern\n");
+  for (std::size_t i = 0; i < sols.size(); ++i) {
+    fprintf(output, "%lf\t%lf\t%lf\t%lf\t%s\n", sols[i].obj, held_out[i].obj, held_out[i].f1,
+            held_out[i].f2, data.get_pat_as_str(held_out[i].pat).c_str());
+    best = std::max(best, held_out[i].obj);
+    total += held_out[i].obj;
+  }
+  fclose(output);
+
+  if (!sols.empty()) {
+    fprintf(stderr, "Held-out obj for PS=%lu: best %lf, mean %lf\n", ps, best, total / sols.size());
+  }
+  data.set_fold(run.fold, run.num_folds);
+}
+
+//------------------------------------------------------------------------------
+// Collects the counters of every rank for the finished level and writes them
+// to ps#.stats.json (ps#.exact.stats.json for an exact search)
+//------------------------------------------------------------------------------
+void GreedyController::report_counters() {
+  char signal = 0;
+  for (std::size_t i = 1; i < world_size; ++i) {
+    MPI_Send(&signal, 1, MPI_CHAR, i, Parallel::STATS_TAG, MPI_COMM_WORLD);
+  }
+  counters.count_sent(world_size - 1, MPI_CHAR);
+
+  const std::vector<double> all_values = counters.gather(0);
+  counters.reset();
+
+  if (screen_fraction < 1.0 && ps >= 3 && !exact) {
+    double candidates = 0.0, screened_out = 0.0;
+    for (std::size_t r = 0; r < world_size; ++r) {
+      candidates += all_values[r * PerfCounters::NUM_FIELDS + PerfCounters::CANDIDATES];
+      screened_out += all_values[r * PerfCounters::NUM_FIELDS + PerfCounters::SCREENED_OUT];
+    }
+    // Every candidate of the level is screened, and each is wrongly dropped
+    // with probability at most SCREEN_ERROR; no more than were dropped can be
+    fprintf(stderr, "Screening dropped %.0f of %.0f candidates for PS=%lu; error rate <= %g per candidate, "
+            "<= %.2f wrongly dropped expected\n", screened_out, candidates, ps, screen_error,
+            std::min(screen_error * candidates, screened_out));
+  }
+
+  std::string file_name = scratch_dir + get_level_name() + ".stats.json";
+  PerfCounters::write_json(file_name, ps, MPI_Wtime() - level_start, all_values);
+
+  tracer.record(Tracer::LEVEL, level_trace_start, ps);
+}
+
+const std::vector<Run> & GreedyController::get_runs() const {
+  return runs;
+}
+
+//------------------------------------------------------------------------------
+// Switches the controller and all workers to the scratch directory, direction,
+// stratum, fold, MIN_OBJ and SOL_POOL_SIZE of runs[index], keeping the loaded
+// data. The pools of the previous run are kept for continue_previous_run.
+//------------------------------------------------------------------------------
+void GreedyController::begin_run(const std::size_t index) {
+  run_index = index;
+  scratch_dir = runs[index].scratch_dir;
+  data.set_risk(runs[index].risk);
+  data.set_stratum(runs[index].stratum);
+  data.set_fold(runs[index].fold, runs[index].num_folds);
+  count_cache.count_bins(data);
+  min_obj = runs[index].min_obj;
+  pool1.set_max_size(runs[index].sol_pool_size);
+  pool2.set_max_size(runs[index].sol_pool_size);
+  lb = min_obj;
+  stop_reason.clear();
+
+  mirror_index = Run::get_mirror(runs, index);
+  if (mirror_index < runs.size()) {
+    mirror_pool.set_max_size(runs[mirror_index].sol_pool_size);
+  }
+
+  for (std::size_t i = 1; i < world_size; ++i) {
+    MPI_Send(&index, 1, CUSTOM_SIZE_T, i, Parallel::RUN_TAG, MPI_COMM_WORLD);
+  }
+  counters.count_sent(world_size - 1, CUSTOM_SIZE_T);
+}
+
+//------------------------------------------------------------------------------
+// If the previous run only differs from the current one in a smaller MAX_PS,
+// copies its outputs to the current scratch directory and returns the last
+// level it completed, so the search goes on from there. Otherwise empties the
+// pools and returns 0.
+//------------------------------------------------------------------------------
+std::size_t GreedyController::continue_previous_run() {
+  const Run &run = runs[run_index];
+  if (run_index > 0) {
+    const Run &prev = runs[run_index - 1];
+    if (prev.risk == run.risk && prev.stratum == run.stratum && prev.fold == run.fold &&
+        prev.min_obj == run.min_obj && prev.sol_pool_size == run.sol_pool_size &&
+        ps == prev.max_ps && prev.max_ps < run.max_ps) {
+      writer.wait();
+      for (std::size_t p = 1; p <= ps; ++p) {
+        const std::string level = "ps" + std::to_string(p);
+        copy_file(prev.scratch_dir + level + ".solPool", scratch_dir + level + ".solPool");
+        copy_file(prev.scratch_dir + level + ".solPool.bin", scratch_dir + level + ".solPool.bin");
+        copy_file(prev.scratch_dir + level + ".stats.json", scratch_dir + level + ".stats.json");
+        if (run.fold > 0) {
+          copy_file(prev.scratch_dir + level + ".heldout.tsv", scratch_dir + level + ".heldout.tsv");
+        }
+      }
+      copy_file(prev.scratch_dir + "markerPairs.csv", scratch_dir + "markerPairs.csv");
+      copy_file(Checkpoint::file_name(prev.scratch_dir), Checkpoint::file_name(scratch_dir));
+      copy_file(CountCache::file_name(prev.scratch_dir), CountCache::file_name(scratch_dir));
+      count_cache.levels.resize(ps);
+      return ps;
+    }
+  }
+
+  pool1.clear();
+  pool2.clear();
+  cur_pool = &pool1;
+  old_pool = &pool2;
+  count_cache.levels.clear();
+  ps = 0;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Fills the current PS1 or PS2 pool from the one an earlier run of the sweep
+// (or the run it is the mirror of) found in the same direction, stratum and
+// fold, if that pool is known to
+// hold this run's: it was found with a MIN_OBJ no larger than this run's and,
+// once filtered to this run's MIN_OBJ, it was either not full or still fills
+// this run's pool.
+// Solutions tied at the end of the pool may be picked differently than a
+// search would. Returns false if the level has to be searched.
+//------------------------------------------------------------------------------
+bool GreedyController::reuse_level() {
+  const Run &run = runs[run_index];
+  const LevelCache &cache = level_cache[run.risk ? 0 : 1][ps - 1];
+  if (!cache.valid || cache.risk != run.risk || cache.stratum != run.stratum ||
+      cache.fold != run.fold || cache.min_obj > min_obj) {
+    return false;
+  }
+
+  // PS1 keeps solutions with obj >= MIN_OBJ and PS2 those with f1 >= MIN_OBJ
+  std::vector<Solution> sols;
+  for (auto &s : cache.sols) {
+    if ((ps == 1 ? s.obj : s.f1) >= min_obj) {
+      sols.push_back(s);
+    }
+  }
+  if (cache.sols.size() == cache.max_size && sols.size() < cur_pool->get_max_size()) {
+    return false;
+  }
+
+  cur_pool->set_solutions(sols);
+  if (cur_pool->size() == cur_pool->get_max_size() && cur_pool->get_min_obj() > lb) {
+    lb = cur_pool->get_min_obj();
+  }
+
+  if (ps == 2 && cache.scratch_dir != scratch_dir) {
+    copy_file(cache.scratch_dir + "markerPairs.csv", scratch_dir + "markerPairs.csv");
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Keeps the searched PS1 or PS2 pool for later runs in the same direction,
+// stratum and fold. The first run of each of them has the lowest MIN_OBJ and
+// the largest SOL_POOL_SIZE, so its pools are the ones kept.
+//------------------------------------------------------------------------------
+void GreedyController::cache_level() {
+  const Run &run = runs[run_index];
+  LevelCache &cache = level_cache[run.risk ? 0 : 1][ps - 1];
+  if (runs.size() == 1 || (cache.valid && cache.risk == run.risk && cache.stratum == run.stratum &&
+                            cache.fold == run.fold)) {
+    return;
+  }
+
+  cache.valid = true;
+  cache.risk = run.risk;
+  cache.stratum = run.stratum;
+  cache.fold = run.fold;
+  cache.min_obj = min_obj;
+  cache.max_size = cur_pool->get_max_size();
+  cache.scratch_dir = scratch_dir;
+  cache.sols = cur_pool->get_solutions();
+}
+
+//------------------------------------------------------------------------------
+// Makes the PS1 or PS2 level being searched also fill the pool of the mirror
+// run, unless there is none or its pool for the level is already cached. Its
+// candidates are the same, so each group is counted once for both directions.
+// The mirror pool is searched with the MIN_OBJ and SOL_POOL_SIZE of the
+// mirror run, which is the first run of its direction, stratum and fold.
+//------------------------------------------------------------------------------
+void GreedyController::begin_mirror() {
+  mirror = false;
+  if (mirror_index == runs.size()) {
+    return;
+  }
+
+  const Run &run = runs[mirror_index];
+  const LevelCache &cache = level_cache[run.risk ? 0 : 1][ps - 1];
+  if (cache.valid && cache.stratum == run.stratum && cache.fold == run.fold) {
+    return;
+  }
+
+  mirror = true;
+  mirror_lb = run.min_obj;
+  mirror_pool.clear();
+  if (ps == 2) {
+    remove_marker_pair_files(run.scratch_dir);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Keeps the mirror pool of the level for the mirror run, which then takes it
+// in reuse_level
+//------------------------------------------------------------------------------
+void GreedyController::cache_mirror() {
+  if (!mirror) {
+    return;
+  }
+
+  const Run &run = runs[mirror_index];
+  LevelCache &cache = level_cache[run.risk ? 0 : 1][ps - 1];
+  cache.valid = true;
+  cache.risk = run.risk;
+  cache.stratum = run.stratum;
+  cache.fold = run.fold;
+  cache.min_obj = run.min_obj;
+  cache.max_size = mirror_pool.get_max_size();
+  cache.scratch_dir = run.scratch_dir;
+  cache.sols = mirror_pool.get_solutions();
+}
+
 void GreedyController::set_ps(const std::size_t _ps) {
   ps = _ps;
+  level_start = MPI_Wtime();
+  level_trace_start = tracer.now();
+}
+
+//------------------------------------------------------------------------------
+// Loads the checkpoint in the scratch directory and returns the last completed
+// pattern size, or 0 if there is no checkpoint to resume from
+//------------------------------------------------------------------------------
+std::size_t GreedyController::resume() {
+  Checkpoint checkpoint;
+  if (!checkpoint.read(Checkpoint::file_name(scratch_dir))) {
+    return 0;
+  }
+
+  if (checkpoint.config_hash != config_hash) {
+    throw std::runtime_error("GreedyController: Checkpoint in " + scratch_dir +
+                             " was written with a different configuration");
+  }
+
+  set_ps(checkpoint.ps);
+  lb = checkpoint.lb;
+  if (checkpoint.stopped) {
+    stop_reason = "a stopping rule ended it after PS" + std::to_string(ps);
+  }
+
+  cur_pool = (ps == 1) ? &pool1 : &pool2;
+  old_pool = (ps == 1) ? &pool2 : &pool1;
+  cur_pool->set_solutions(checkpoint.sols);
+
+  // Levels missing from the count cache are marked as not exact
+  CountCache saved;
+  if (saved.read(CountCache::file_name(scratch_dir))) {
+    count_cache.levels = saved.levels;
+  }
+  count_cache.levels.resize(ps);
+
+  return ps;
 }
 
 void GreedyController::solve_ps1() {
   set_ps(1);
 
+  if (reuse_level()) {
+    save_level();
+    report_counters();
+    return;
+  }
+
+  begin_mirror();
   std::size_t delta = data.get_num_bins() / (world_size-1);
 
   for (std::size_t i = 1; i < world_size; ++i) {
@@ -146,8 +896,92 @@ void GreedyController::solve_ps1() {
     receive_completion();
   }
 
-  std::string file_name = scratch_dir + "ps1.solPool";
-  cur_pool->write_to_file(file_name, data);
+  if (worker_pools) {
+    flush_worker_pools();
+  }
+
+  cache_level();
+  cache_mirror();
+  mirror = false;
+  save_level();
+  report_counters();
+}
+
+//------------------------------------------------------------------------------
+// Returns the order in which the PS2 markers are dispatched. With the 'cost'
+// schedule, markers are sent longest-expected-first, where the cost of marker
+// i is the number of bins after it times the number of individuals that have
+// it (the reduced groups scanned for each of those bins).
+//------------------------------------------------------------------------------
+std::vector<std::size_t> GreedyController::get_ps2_order() const {
+  const std::size_t num_markers = data.get_num_bins() - 1;
+  std::vector<std::size_t> order(num_markers);
+
+  if (ps2_schedule == "ordered") {
+    for (std::size_t i = 0; i < num_markers; ++i) {
+      order[i] = i;
+    }
+    return order;
+  }
+
+  std::vector<std::pair<double, std::size_t>> costs(num_markers);
+  std::vector<uint64_t> cover;
+  for (std::size_t i = 0; i < num_markers; ++i) {
+    data.get_cover(Pattern(1, i), cover);
+    const double support = data.count_in_mask(cover, data.get_grp1_mask()) +
+                           data.count_in_mask(cover, data.get_grp2_mask());
+    costs[i] = std::make_pair((num_markers - i) * (support + 1.0), i);
+  }
+  std::stable_sort(costs.begin(), costs.end(), utils::SortPairByFirstItemDecreasing());
+
+  for (std::size_t i = 0; i < num_markers; ++i) {
+    order[i] = costs[i].second;
+  }
+  return order;
+}
+
+//------------------------------------------------------------------------------
+// Splits the parents of the level into the tasks of the central scheduler.
+// Sorted by bin, the parents are the leaves of a prefix trie; each task takes
+// a run of them at least 1/SUBTREES_PER_WORKER of a worker's share long and
+// only ends between subtrees, never between parents that differ in the last
+// bin alone. Tasks go out in the order of their best parent in the pool, so
+// good solutions still raise lb early.
+//------------------------------------------------------------------------------
+std::vector<std::vector<Pattern>> GreedyController::get_subtrees() const {
+  const std::vector<Solution> sols = old_pool->get_solutions();
+  std::vector<std::size_t> order(sols.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(),
+            [&sols](const std::size_t a, const std::size_t b) { return sols[a].pat < sols[b].pat; });
+
+  const std::size_t target = std::max<std::size_t>(1, sols.size() / (SUBTREES_PER_WORKER * (world_size - 1)));
+  std::vector<std::pair<std::size_t, std::vector<Pattern>>> tasks;
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    const Pattern &pat = sols[order[k]].pat;
+    bool sibling = false;
+    if (k > 0 && !tasks.back().second.empty()) {
+      const Pattern &prev = tasks.back().second.back();
+      sibling = prev.size() == pat.size() && std::equal(pat.begin(), pat.end() - 1, prev.begin());
+    }
+
+    if (tasks.empty() || (tasks.back().second.size() >= target && !sibling)) {
+      tasks.push_back(std::make_pair(order[k], std::vector<Pattern>()));
+    }
+    tasks.back().first = std::min(tasks.back().first, order[k]);
+    tasks.back().second.push_back(pat);
+  }
+  std::sort(tasks.begin(), tasks.end(),
+            [](const std::pair<std::size_t, std::vector<Pattern>> &a,
+               const std::pair<std::size_t, std::vector<Pattern>> &b) { return a.first < b.first; });
+
+  std::vector<std::vector<Pattern>> subtrees;
+  for (auto &t : tasks) {
+    subtrees.push_back(t.second);
+  }
+  return subtrees;
 }
 
 void GreedyController::solve_ps2() {
@@ -155,10 +989,23 @@ void GreedyController::solve_ps2() {
 
   cur_pool = &pool2;
   old_pool = &pool1;
+  cur_pool->clear();
 
   lb = min_obj;
 
-  for (std::size_t i = 0; i < data.get_num_bins()-1; ++i) {
+  if (reuse_level()) {
+    save_level();
+    report_counters();
+
+    fprintf(stderr, "Greedy max obj for PS=%lu: %lf\n", ps, cur_pool->get_max_obj());
+    fprintf(stderr, "Greedy min obj for PS=%lu: %lf\n", ps, cur_pool->get_min_obj());
+    return;
+  }
+
+  remove_marker_pair_files(scratch_dir);
+  begin_mirror();
+
+  for (auto i : get_ps2_order()) {
     send_ps2_problem(i);
   }
 
@@ -166,13 +1013,23 @@ void GreedyController::solve_ps2() {
     receive_completion();
   }
 
-  std::string file_name = scratch_dir + "ps2.solPool";
-  cur_pool->write_to_file(file_name, data);
+  if (worker_pools) {
+    flush_worker_pools();
+  }
+
+  cache_level();
+  cache_mirror();
+  save_level();
+  report_counters();
 
   fprintf(stderr, "Greedy max obj for PS=%lu: %lf\n", ps, cur_pool->get_max_obj());
   fprintf(stderr, "Greedy min obj for PS=%lu: %lf\n", ps, cur_pool->get_min_obj());
 
-  combine_marker_pair_files();
+  combine_marker_pair_files(scratch_dir);
+  if (mirror) {
+    combine_marker_pair_files(runs[mirror_index].scratch_dir);
+  }
+  mirror = false;
 }
 
 void GreedyController::solve() {
@@ -182,24 +1039,87 @@ void GreedyController::solve() {
   cur_pool->clear();
 
   lb = min_obj;
-  for (std::size_t i = 0; i < old_pool->size(); ++i) {
-    send_problem(old_pool->get_sol(i));
+  if (scheduler == "distributed") {
+    distribute_problems();
+    reduce_pools();
+  } else {
+    for (auto &parents : get_subtrees()) {
+      send_problem(parents);
+    }
+
+    while (!unavailable_workers.empty()) {
+      receive_completion();
+    }
+
+    if (worker_pools) {
+      flush_worker_pools();
+    }
+  }
+
+  save_level();
+  report_counters();
+
+  fprintf(stderr, "Greedy max obj for PS=%lu: %lf\n", ps, cur_pool->get_max_obj());
+  fprintf(stderr, "Greedy min obj for PS=%lu: %lf\n", ps, cur_pool->get_min_obj());
+}
+
+//------------------------------------------------------------------------------
+// Finds the global top SOL_POOL_SIZE patterns of the given size. Each task is
+// the subtree of patterns whose smallest bin is one marker. Markers are sent in
+// decreasing order of group 1 support so good patterns raise lb early, and
+// dispatch stops at the first marker whose support is below lb, since obj can
+// be at most f1.
+//------------------------------------------------------------------------------
+void GreedyController::solve_exact(const std::size_t size) {
+  exact = true;
+  set_ps(size);
+
+  cur_pool = &pool1;
+  old_pool = &pool2;
+  cur_pool->clear();
+
+  lb = min_obj;
+
+  std::vector<std::pair<double, std::size_t>> support(data.get_num_bins());
+  std::vector<uint64_t> cover;
+  for (std::size_t i = 0; i < data.get_num_bins(); ++i) {
+    data.get_cover(Pattern(1, i), cover);
+    support[i] = std::make_pair(static_cast<double>(data.count_in_mask(cover, data.get_grp1_mask())) /
+                                data.get_num_grp1(), i);
+  }
+  std::stable_sort(support.begin(), support.end(), utils::SortPairByFirstItemDecreasing());
+
+  for (auto &s : support) {
+    if (s.first < lb) {
+      break;
+    }
+    send_exact_problem(s.second);
   }
 
   while (!unavailable_workers.empty()) {
     receive_completion();
   }
 
-  std::string file_name = scratch_dir + "ps" + std::to_string(ps) + ".solPool";
-  cur_pool->write_to_file(file_name, data);
+  if (worker_pools) {
+    flush_worker_pools();
+  }
 
-  fprintf(stderr, "Greedy max obj for PS=%lu: %lf\n", ps, cur_pool->get_max_obj());
-  fprintf(stderr, "Greedy min obj for PS=%lu: %lf\n", ps, cur_pool->get_min_obj());
+  save_level();
+  report_counters();
+
+  if (cur_pool->size() > 0) {
+    fprintf(stderr, "Exact max obj for PS=%lu: %lf\n", ps, cur_pool->get_max_obj());
+    fprintf(stderr, "Exact min obj for PS=%lu: %lf\n", ps, cur_pool->get_min_obj());
+  }
+
+  exact = false;
 }
 
-void GreedyController::signal_workers_to_end() const {
+void GreedyController::signal_workers_to_end() {
   char signal = 0;
   for (std::size_t i = 1; i < world_size; ++i) {
     MPI_Send(&signal, 1, MPI_CHAR, i, Parallel::CONVERGE_TAG, MPI_COMM_WORLD);
   }
+
+  tracer.write(0);
 }
\ No newline at end of file
@@ -5,46 +5,125 @@
 #include <stack>
 #include <set>
 #include "ConfigParser.h"
+#include "CountCache.h"
 #include "ExprsData.h"
+#include "Run.h"
 #include "SolPool.h"
+#include "PoolWriter.h"
+#include "PerfCounters.h"
+#include "Tracer.h"
 
 class GreedyController {
   private:
+    // Pool of a finished PS1 or PS2 level, kept so later runs of a sweep in the
+    // same direction, or the mirror run of RISK both, can take their pool from
+    // it instead of searching again
+    struct LevelCache {
+      bool valid;
+      bool risk;
+      std::string stratum;
+      std::size_t fold;
+      double min_obj;
+      std::size_t max_size;
+      std::string scratch_dir;
+      std::vector<Solution> sols;
+    };
+
     const ConfigParser *parser;
-    const ExprsData data;
+    ExprsData data;
     const std::size_t world_size;
-    const std::string scratch_dir;
-    const double min_obj;
+    const std::vector<Run> runs;
+    std::size_t run_index;
+    std::string scratch_dir;
+    double min_obj;
+    const uint64_t config_hash;
+    const std::string ps2_schedule;
+    const std::string scheduler;
+    const bool worker_pools;
+    const double screen_fraction;
+    const double screen_error;
+    const std::size_t stop_no_improvement;
+    const double stop_min_gain;
+    const bool stop_below_min_obj;
+    const double stop_pool_fraction;
+    std::string stop_reason;
 
     std::stack<int> available_workers;
     std::set<int> unavailable_workers;
 
     std::size_t ps;
+    bool exact;
+    double level_start;
+    double level_trace_start;
 
     SolPool pool1;
     SolPool pool2;
     SolPool *cur_pool;
     SolPool *old_pool;
     double lb;
+
+    // With RISK both, PS1 and PS2 also fill the pool of the mirror run
+    // (Run::get_mirror) from the same counts, with the groups swapped
+    std::size_t mirror_index;
+    bool mirror;
+    SolPool mirror_pool;
+    double mirror_lb;
+
+    // Indexed by direction (risk first) and level
+    LevelCache level_cache[2][2];
+    CountCache count_cache;
+
+    const PoolWriter::Format pool_format;
+    PoolWriter writer;
+    PerfCounters counters;
+    Tracer tracer;
   
     void send_ps1_problem(const std::size_t start, const std::size_t stop);
     void send_ps2_problem(const std::size_t marker);
-    void send_problem(const std::vector<std::size_t> &sol);
+    void send_mirror(const int worker, const int tag);
+    void send_problem(const std::vector<Pattern> &parents);
+    void send_exact_problem(const std::size_t first_bin);
+    void distribute_problems();
+    void reduce_pools();
+    void flush_worker_pools();
 
     void receive_completion();
+    std::vector<Solution> receive_solutions(const int worker);
+    void merge_solutions(const std::vector<Solution> &sols, SolPool &pool, double &bound);
 
-    void combine_marker_pair_files();
+    std::vector<std::size_t> get_ps2_order() const;
+    std::vector<std::vector<Pattern>> get_subtrees() const;
+    void combine_marker_pair_files(const std::string &dir);
+    void remove_marker_pair_files(const std::string &dir) const;
+    bool reuse_level();
+    void cache_level();
+    void begin_mirror();
+    void cache_mirror();
+    void save_level();
+    std::string check_stop() const;
+    void score_held_out(const std::vector<Solution> &sols);
+    void report_counters();
+    std::string get_level_name() const;
 
   public:
+    // Tasks per worker the parents of a level are split into
+    static const std::size_t SUBTREES_PER_WORKER = 4;
+
     GreedyController(const ConfigParser &_parser);
     ~GreedyController();
 
+    const std::vector<Run> & get_runs() const;
+    void begin_run(const std::size_t index);
+    std::size_t continue_previous_run();
     void set_ps(const std::size_t _ps);
+    std::size_t resume();
     void solve_ps1();
     void solve_ps2();
     void solve();
+    void solve_exact(const std::size_t size);
+    const std::string & get_stop_reason() const;
 
-    void signal_workers_to_end() const;
+    void signal_workers_to_end();
 };
 
 #endif
\ No newline at end of file
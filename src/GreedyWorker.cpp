@@ -1,23 +1,47 @@
 #include "GreedyWorker.h"
 #include "Parallel.h"
+#include "PoolReduce.h"
+#include "Utils.h"
+#include "WorkQueue.h"
+#include <cmath>
+#include <limits>
+#include <random>
 
 GreedyWorker::GreedyWorker(const ConfigParser &_parser) : parser(&_parser),
                                                           data(*parser),
-                                                          scratch_dir(parser->getString("SCRATCH_DIR")),
+                                                          runs(Run::list(*parser)),
+                                                          scratch_dir(runs[0].scratch_dir),
                                                           world_rank(Parallel::get_world_rank()),
+                                                          worker_pools(parser->hasParameter("WORKER_POOLS") &&
+                                                                       parser->getBool("WORKER_POOLS")),
+                                                          screen_fraction(parser->hasParameter("SCREEN_FRACTION") ?
+                                                                          parser->getDouble("SCREEN_FRACTION") : 1.0),
+                                                          screen_error(parser->hasParameter("SCREEN_ERROR") ?
+                                                                       parser->getDouble("SCREEN_ERROR") : 0.001),
                                                           tag(0),
                                                           start(0),
                                                           stop(0),
+                                                          ps(0),
                                                           min_obj(0.0),
-                                                          sol_pool(parser->getSizeT("SOL_POOL_SIZE")),
-                                                          end_(false) {}
+                                                          parent_size(0),
+                                                          mirror(false),
+                                                          mirror_min_obj(0.0),
+                                                          sol_pool(runs[0].sol_pool_size),
+                                                          mirror_pool(runs[0].sol_pool_size),
+                                                          tracer(*parser),
+                                                          end_(false) {
+  build_screen_sample();
+}
 
 GreedyWorker::~GreedyWorker() {}
 
 void GreedyWorker::receive_problem() {
   MPI_Status status;
+  const double trace_start = tracer.now();
+  counters.start_mpi();
   // Check if signal to end was received
   MPI_Probe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+  mirror = false;
 
   if (status.MPI_TAG == Parallel::CONVERGE_TAG) {
     tag = Parallel::CONVERGE_TAG;
@@ -27,72 +51,256 @@ void GreedyWorker::receive_problem() {
 
     end_ = true;
 
+  } else if (status.MPI_TAG == Parallel::STATS_TAG) {
+    tag = Parallel::STATS_TAG;
+
+    char signal;
+    MPI_Recv(&signal, 1, MPI_CHAR, 0, Parallel::STATS_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(1, MPI_CHAR);
+
+  } else if (status.MPI_TAG == Parallel::RUN_TAG) {
+    tag = Parallel::RUN_TAG;
+
+    std::size_t index;
+    MPI_Recv(&index, 1, CUSTOM_SIZE_T, 0, Parallel::RUN_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(1, CUSTOM_SIZE_T);
+
+    scratch_dir = runs[index].scratch_dir;
+    data.set_risk(runs[index].risk);
+    data.set_stratum(runs[index].stratum);
+    data.set_fold(runs[index].fold, runs[index].num_folds);
+    sol_pool.set_max_size(runs[index].sol_pool_size);
+    build_screen_sample();
+
+    const std::size_t mirror_index = Run::get_mirror(runs, index);
+    if (mirror_index < runs.size()) {
+      mirror_dir = runs[mirror_index].scratch_dir;
+      mirror_pool.set_max_size(runs[mirror_index].sol_pool_size);
+    }
+
+  } else if (status.MPI_TAG == Parallel::FLUSH_TAG) {
+    tag = Parallel::FLUSH_TAG;
+
+    std::size_t header[2];
+    MPI_Recv(header, 2, CUSTOM_SIZE_T, 0, Parallel::FLUSH_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(2, CUSTOM_SIZE_T);
+    ps = header[0];
+    mirror = header[1] != 0;
+
+  } else if (status.MPI_TAG == Parallel::EXACT_TAG) {
+    tag = Parallel::EXACT_TAG;
+
+    MPI_Recv(&start, 1, CUSTOM_SIZE_T, 0, Parallel::EXACT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Recv(&ps, 1, CUSTOM_SIZE_T, 0, Parallel::EXACT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Recv(&min_obj, 1, MPI_DOUBLE, 0, Parallel::EXACT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(2, CUSTOM_SIZE_T);
+    counters.count_recv(1, MPI_DOUBLE);
+
+  } else if (status.MPI_TAG == Parallel::DISTRIBUTED_TAG) {
+    tag = Parallel::DISTRIBUTED_TAG;
+
+    char signal;
+    MPI_Recv(&signal, 1, MPI_CHAR, 0, Parallel::DISTRIBUTED_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(1, MPI_CHAR);
+
   } else if (status.MPI_TAG == Parallel::PS1_TAG) {
     tag = Parallel::PS1_TAG;
     
     MPI_Recv(&start, 1, CUSTOM_SIZE_T, 0, Parallel::PS1_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
     MPI_Recv(&stop, 1, CUSTOM_SIZE_T, 0, Parallel::PS1_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
     MPI_Recv(&min_obj, 1, MPI_DOUBLE, 0, Parallel::PS1_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-  
+    counters.count_recv(2, CUSTOM_SIZE_T);
+    counters.count_recv(1, MPI_DOUBLE);
+    receive_mirror(Parallel::PS1_TAG);
+
   } else if (status.MPI_TAG == Parallel::PS2_TAG) {
     tag = Parallel::PS2_TAG;
 
     MPI_Recv(&start, 1, CUSTOM_SIZE_T, 0, Parallel::PS2_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
     MPI_Recv(&min_obj, 1, MPI_DOUBLE, 0, Parallel::PS2_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(1, CUSTOM_SIZE_T);
+    counters.count_recv(1, MPI_DOUBLE);
+    receive_mirror(Parallel::PS2_TAG);
 
   } else if (status.MPI_TAG == Parallel::GREEDY_TAG) {
     tag = Parallel::GREEDY_TAG;
 
-    // Receive number of markers in solution
-    std::size_t sol_size;
-    MPI_Recv(&sol_size, 1, CUSTOM_SIZE_T, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    sol.resize(sol_size);
+    // Receive number of parents and markers per parent
+    std::size_t header[2];
+    MPI_Recv(header, 2, CUSTOM_SIZE_T, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    parent_size = header[1];
+    parents.resize(header[0] * header[1]);
 
-    // Receive solution
-    MPI_Recv(&sol[0], sol_size, CUSTOM_SIZE_T, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    // Receive parents
+    MPI_Recv(parents.data(), parents.size(), MPI_UINT32_T, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD,
+             MPI_STATUS_IGNORE);
 
     // Receive lb
     MPI_Recv(&min_obj, 1, MPI_DOUBLE, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(2, CUSTOM_SIZE_T);
+    counters.count_recv(parents.size(), MPI_UINT32_T);
+    counters.count_recv(1, MPI_DOUBLE);
 
   } else {
     fprintf(stderr, "Unknown tag\n");
     exit(EXIT_FAILURE);
   }
+  counters.stop_mpi();
+  tracer.record(Tracer::WAIT, trace_start, tag);
+}
+
+//------------------------------------------------------------------------------
+// Receives whether the PS1 or PS2 task also fills the mirror pool and, if so,
+// the MIN_OBJ of the mirror run
+//------------------------------------------------------------------------------
+void GreedyWorker::receive_mirror(const int tag) {
+  char signal;
+  MPI_Recv(&signal, 1, MPI_CHAR, 0, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  counters.count_recv(1, MPI_CHAR);
+  mirror = signal != 0;
+
+  if (mirror) {
+    MPI_Recv(&mirror_min_obj, 1, MPI_DOUBLE, 0, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    counters.count_recv(1, MPI_DOUBLE);
+  }
 }
 
 void GreedyWorker::send_back_solution() {
+  const double trace_start = tracer.now();
+  counters.start_mpi();
+
+  // With worker pools only the pruning thresholds go back; the pools are sent
+  // when the level is flushed
+  if (worker_pools) {
+    const double thresholds[2] = {min_obj, mirror_min_obj};
+    MPI_Send(thresholds, mirror ? 2 : 1, MPI_DOUBLE, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
+    counters.count_sent(mirror ? 2 : 1, MPI_DOUBLE);
+    counters.stop_mpi();
+    tracer.record(Tracer::SEND_BACK, trace_start, 0);
+    return;
+  }
+
+  send_pool(sol_pool);
+  if (mirror) {
+    send_pool(mirror_pool);
+  }
+
+  counters.stop_mpi();
+  tracer.record(Tracer::SEND_BACK, trace_start, sol_pool.size() + (mirror ? mirror_pool.size() : 0));
+}
+
+void GreedyWorker::send_pool(const SolPool &pool) {
   // Send number of solutions in pool
-  const std::size_t num_sols = sol_pool.size();
+  const std::size_t num_sols = pool.size();
   MPI_Send(&num_sols, 1, CUSTOM_SIZE_T, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
 
   // Send each solution
-  for (std::size_t i = 0; i < num_sols; ++i) {
-    auto pair = sol_pool.get_obj_sol_pair(i);
-    
-    MPI_Send(&pair.second[0], pair.second.size(), CUSTOM_SIZE_T, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
-    MPI_Send(&pair.first, 1, MPI_DOUBLE, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
+  for (auto &s : pool.get_solutions()) {
+    const double vals[3] = {s.obj, s.f1, s.f2};
+
+    MPI_Send(&s.pat[0], s.pat.size(), MPI_UINT32_T, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
+    MPI_Send(vals, 3, MPI_DOUBLE, 0, Parallel::GREEDY_TAG, MPI_COMM_WORLD);
+    counters.count_sent(s.pat.size(), MPI_UINT32_T);
+    counters.count_sent(3, MPI_DOUBLE);
+  }
+  counters.count_sent(1, CUSTOM_SIZE_T);
+}
+
+//------------------------------------------------------------------------------
+// Contributes this rank's pool, and then its mirror pool if the level has one,
+// to the tree reduction of all pools on rank 0
+//------------------------------------------------------------------------------
+void GreedyWorker::reduce_pool() {
+  const double trace_start = tracer.now();
+  counters.start_mpi();
+
+  PoolReduce::reduce(sol_pool.get_solutions(), ps, sol_pool.get_max_size(), 0);
+  counters.count_sent(PoolReduce::get_buffer_size(ps, sol_pool.get_max_size()), MPI_BYTE);
+  if (mirror) {
+    PoolReduce::reduce(mirror_pool.get_solutions(), ps, mirror_pool.get_max_size(), 0);
+    counters.count_sent(PoolReduce::get_buffer_size(ps, mirror_pool.get_max_size()), MPI_BYTE);
+  }
+
+  counters.stop_mpi();
+  tracer.record(Tracer::SEND_BACK, trace_start, sol_pool.size());
+}
+
+//------------------------------------------------------------------------------
+// Contributes this rank's counters for the finished level to rank 0
+//------------------------------------------------------------------------------
+void GreedyWorker::report_counters() {
+  counters.gather(0);
+  counters.reset();
+}
+
+//------------------------------------------------------------------------------
+// Adds a solution to the pool and raises min_obj once the pool is full
+//------------------------------------------------------------------------------
+void GreedyWorker::add_solution(const double f1, const double f2, const Pattern &pat) {
+  if (sol_pool.add_solution(f1, f2, pat)) {
+    counters.add(PerfCounters::POOL_INSERTS);
+  } else {
+    counters.add(PerfCounters::POOL_REJECTS);
+  }
+
+  raise_min_obj();
+}
+
+//------------------------------------------------------------------------------
+// Adds a solution of the mirror run, with f1 and f2 already swapped to its
+// groups
+//------------------------------------------------------------------------------
+void GreedyWorker::add_mirror_solution(const double f1, const double f2, const Pattern &pat) {
+  if (mirror_pool.add_solution(f1, f2, pat)) {
+    counters.add(PerfCounters::POOL_INSERTS);
+  } else {
+    counters.add(PerfCounters::POOL_REJECTS);
+  }
+
+  raise_min_obj();
+}
+
+//------------------------------------------------------------------------------
+// Raises min_obj to the worst solution in the pool once the pool is full, and
+// mirror_min_obj likewise for the mirror pool
+//------------------------------------------------------------------------------
+void GreedyWorker::raise_min_obj() {
+  if (sol_pool.size() == sol_pool.get_max_size() &&
+      sol_pool.get_min_obj() > min_obj) {
+    min_obj =  sol_pool.get_min_obj();
+  }
+  if (mirror && mirror_pool.size() == mirror_pool.get_max_size() &&
+      mirror_pool.get_min_obj() > mirror_min_obj) {
+    mirror_min_obj = mirror_pool.get_min_obj();
   }
 }
 
 void GreedyWorker::calc_ps1() {
-  std::vector<std::size_t> sol(1);
+  Pattern sol(1);
 
   for (std::size_t i = start; i <= stop; ++i) {
     sol[0] = i;
     double f1 = data.get_grp1_freq(sol);
+    counters.add(PerfCounters::CANDIDATES);
+
+    // The mirror run needs f2 of every candidate, as it is its f1
+    double f2 = mirror ? data.get_grp2_freq(sol) : 0.0;
 
     if (f1 >= min_obj) {
-      double obj = f1 - data.get_grp2_freq(sol);
+      counters.add(PerfCounters::F1_PASSED);
+      if (!mirror) {
+        f2 = data.get_grp2_freq(sol);
+      }
+      double obj = f1 - f2;
 
       if (obj >= min_obj) {
-        sol_pool.add_solution(obj, sol);
-      
-        if (sol_pool.size() == sol_pool.get_max_size() &&
-            sol_pool.get_min_obj() > min_obj) {
-          min_obj =  sol_pool.get_min_obj();
-        }
+        add_solution(f1, f2, sol);
       }
     }
+
+    if (mirror && f2 - f1 >= mirror_min_obj) {
+      add_mirror_solution(f2, f1, sol);
+    }
   }
 }
 
@@ -101,24 +309,46 @@ void GreedyWorker::calc_ps2() {
   FILE *pair_count_stream = open_file(pairs_file);
 
   std::vector<std::size_t> count(data.get_num_bins() - 1 - start, 0);
+  std::vector<std::size_t> mirror_count(mirror ? count.size() : 0, 0);
   std::vector<std::size_t> red_g1, red_g2;
 
   // Initialize solution to 'start' marker
-  std::vector<std::size_t> sol = {start};
+  Pattern sol = {start};
   
   // Reduce the individuals from group1 to only those that contain the 'start' marker
-  for (std::size_t j = data.get_grp1_start(); j <= data.get_grp1_stop(); ++j) {
+  for (auto j : data.get_grp1_indivs()) {
     if (data.indiv_has_pat(j, sol)) {
       red_g1.push_back(j);
     }
   }
   // Reduce the individuals from group1 to only those that contain the 'start' marker
-  for (std::size_t j = data.get_grp2_start(); j <= data.get_grp2_stop(); ++j) {
+  for (auto j : data.get_grp2_indivs()) {
     if (data.indiv_has_pat(j, sol)) {
       red_g2.push_back(j);
     }
   }
 
+  // Sparse bins are counted against the cover of 'start' instead
+  std::vector<uint64_t> cover;
+  data.get_cover(sol, cover);
+  const uint64_t *grp1 = data.get_grp1_mask().data();
+  const uint64_t *grp2 = data.get_grp2_mask().data();
+
+  // Number of individuals of 'reduced group 2' that contain the i-th marker
+  auto count_grp2 = [&](const std::size_t i) {
+    std::size_t c = 0;
+    if (data.is_sparse(i)) {
+      c = data.count_bin(i, cover.data(), grp2);
+    } else {
+      for (auto j : red_g2) {
+        if (data.get_bin(i,j)) {
+          ++c;
+        }
+      }
+    }
+    return c;
+  };
+
   // Add dummy marker to solution
   sol.push_back(0);
 
@@ -127,55 +357,195 @@ void GreedyWorker::calc_ps2() {
     count[i - start - 1] = 0; // Initialze count to zero
     
     // Count the number of individuals 'reduced group 1' that contain the i-th marker
-    for (auto j : red_g1) {
-      if (data.get_bin(i,j)) {
-        ++count[i - start - 1];
+    if (data.is_sparse(i)) {
+      count[i - start - 1] = data.count_bin(i, cover.data(), grp1);
+    } else {
+      for (auto j : red_g1) {
+        if (data.get_bin(i,j)) {
+          ++count[i - start - 1];
+        }
       }
     }
 
     double f1 = static_cast<double>(count[i - start - 1])  / data.get_num_grp1();
+    counters.add(PerfCounters::CANDIDATES);
 
-    if (f1 >= min_obj) {
-      double f2 = 0.0;
-      for (auto j : red_g2) {
-        if (data.get_bin(i,j)) {
-          ++f2;
-        }
-      }
-      f2 /= data.get_num_grp2();
+    // The mirror run needs group 2 of every marker counted, as it is its
+    // group 1
+    const std::size_t count2 = (mirror || f1 >= min_obj) ? count_grp2(i) : 0;
+    const double f2 = static_cast<double>(count2) / data.get_num_grp2();
+    sol[1] = i;
 
-      double obj = f1 - f2;
-      sol[1] = i;
-      sol_pool.add_solution(obj, sol);
+    if (f1 >= min_obj) {
+      counters.add(PerfCounters::F1_PASSED);
+      add_solution(f1, f2, sol);
+    }
 
-      if (sol_pool.size() == sol_pool.get_max_size() &&
-        sol_pool.get_min_obj() > min_obj) {
-        min_obj =  sol_pool.get_min_obj();
+    if (mirror) {
+      mirror_count[i - start - 1] = count2;
+      if (f2 >= mirror_min_obj) {
+        add_mirror_solution(f2, f1, sol);
       }
-    }    
+    }
   }
   record_pair_count(pair_count_stream, count);
   close_file(pair_count_stream);
+
+  if (mirror) {
+    FILE *mirror_stream = open_file(mirror_dir + "markerPairs_part" + std::to_string(world_rank) + ".csv");
+    record_pair_count(mirror_stream, mirror_count);
+    close_file(mirror_stream);
+  }
 }
 
-void GreedyWorker::calc() {
-  std::vector<std::size_t> red_g1, red_g2;
-  // Reduce the individuals from group1 to only those that contain the pattern
-  for (std::size_t j = data.get_grp1_start(); j <= data.get_grp1_stop(); ++j) {
-    if (data.indiv_has_pat(j, sol)) {
-      red_g1.push_back(j);
+//------------------------------------------------------------------------------
+// Picks SCREEN_FRACTION of the individuals of each group with a fixed seed, so
+// every rank and both directions use the same sample, and sets the Hoeffding
+// margin of each group for the current direction and active individuals:
+// with m sampled individuals, a frequency exceeds its sample estimate by more
+// than sqrt(ln(2/d) / 2m) with probability at most d/2, also when sampling
+// without replacement.
+//------------------------------------------------------------------------------
+void GreedyWorker::build_screen_sample() {
+  if (screen_fraction >= 1.0) {
+    return;
+  }
+
+  std::size_t ranges[2][2] = {{data.get_grp1_start(), data.get_grp1_stop()},
+                              {data.get_grp2_start(), data.get_grp2_stop()}};
+  if (ranges[1][0] < ranges[0][0]) {
+    std::swap(ranges[0], ranges[1]);
+  }
+
+  in_screen.assign(std::max(ranges[0][1], ranges[1][1]) + 1, 0);
+  std::mt19937 rng(0);
+  for (auto &r : ranges) {
+    std::vector<std::size_t> ids;
+    for (std::size_t j = r[0]; j <= r[1]; ++j) {
+      ids.push_back(j);
+    }
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    const std::size_t num_sampled = static_cast<std::size_t>(std::ceil(screen_fraction * ids.size()));
+    for (std::size_t k = 0; k < num_sampled; ++k) {
+      in_screen[ids[k]] = 1;
+    }
+  }
+
+  screen_size[0] = std::count_if(data.get_grp1_indivs().begin(), data.get_grp1_indivs().end(),
+                                 [this](const std::size_t j) { return in_screen[j]; });
+  screen_size[1] = std::count_if(data.get_grp2_indivs().begin(), data.get_grp2_indivs().end(),
+                                 [this](const std::size_t j) { return in_screen[j]; });
+  for (std::size_t g = 0; g < 2; ++g) {
+    screen_margin[g] = screen_size[g] > 0 ? std::sqrt(std::log(2.0 / screen_error) / (2.0 * screen_size[g])) :
+                                            std::numeric_limits<double>::infinity();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Estimates f1 and f2 of sol extended by bin from the sampled individuals that
+// have sol (red_s1, red_s2). Returns false if the upper confidence bound on
+// f1, or on obj, is below min_obj, which wrongly drops a candidate with
+// probability at most SCREEN_ERROR.
+//------------------------------------------------------------------------------
+bool GreedyWorker::passes_screen(const std::size_t bin, const std::vector<std::size_t> &red_s1,
+                                 const std::vector<std::size_t> &red_s2) const {
+  double count = 0.0;
+  for (auto j : red_s1) {
+    if (data.get_bin(bin, j)) {
+      ++count;
+    }
+  }
+
+  const double f1_ub = count / screen_size[0] + screen_margin[0];
+  if (f1_ub < min_obj) {
+    return false;
+  }
+
+  count = 0.0;
+  for (auto j : red_s2) {
+    if (data.get_bin(bin, j)) {
+      ++count;
     }
   }
+  return f1_ub - (count / screen_size[1] - screen_margin[1]) >= min_obj;
+}
+
+//------------------------------------------------------------------------------
+// Starts a new set of parents from the empty prefix, which every individual of
+// the active groups has
+//------------------------------------------------------------------------------
+void GreedyWorker::reset_prefixes() {
+  prefixes.resize(1);
+  prefixes[0].cover.assign(data.get_num_words(), ~static_cast<uint64_t>(0));
+  prefixes[0].red_g1 = data.get_grp1_indivs();
+  prefixes[0].red_g2 = data.get_grp2_indivs();
+  prefix_pat.clear();
+}
+
+//------------------------------------------------------------------------------
+// Makes pat the current prefix. Only the bins after its common prefix with the
+// previous one are intersected, so a subtree of the trie of sorted parents
+// pays for each shared prefix once rather than once per parent.
+//------------------------------------------------------------------------------
+void GreedyWorker::descend(const Pattern &pat) {
+  std::size_t depth = 0;
+  while (depth < prefix_pat.size() && depth < pat.size() && prefix_pat[depth] == pat[depth]) {
+    ++depth;
+  }
+
+  if (prefixes.size() < pat.size() + 1) {
+    prefixes.resize(pat.size() + 1);
+  }
+  for (std::size_t d = depth; d < pat.size(); ++d) {
+    const Prefix &parent = prefixes[d];
+    Prefix &child = prefixes[d + 1];
+
+    child.cover = parent.cover;
+    data.and_bin(pat[d], child.cover.data());
+
+    child.red_g1.clear();
+    for (auto j : parent.red_g1) {
+      if (data.get_bin(pat[d], j)) {
+        child.red_g1.push_back(j);
+      }
+    }
+    child.red_g2.clear();
+    for (auto j : parent.red_g2) {
+      if (data.get_bin(pat[d], j)) {
+        child.red_g2.push_back(j);
+      }
+    }
+  }
+  prefix_pat = pat;
+}
+
+//------------------------------------------------------------------------------
+// Extends sol by every other bin; descend(sol) must have been called. With
+// SCREEN_FRACTION below 1, a candidate is first screened on the sample of each
+// group and only the survivors are scored on the full groups, so every pooled
+// f1 and f2 is exact.
+//------------------------------------------------------------------------------
+void GreedyWorker::calc() {
+  // The individuals from each group that contain the pattern
+  const std::vector<std::size_t> &red_g1 = prefixes[sol.size()].red_g1;
+  const std::vector<std::size_t> &red_g2 = prefixes[sol.size()].red_g2;
 
   // // Check if f1 values are being recorded or if the f1 value is >= min_obj
   if (static_cast<double>(red_g1.size()) / data.get_num_grp1() >= min_obj) {
-    // Reduce the individuals from group2 to only those that contain the pattern
-    for (std::size_t j = data.get_grp2_start(); j <= data.get_grp2_stop(); ++j) {
-      if (data.indiv_has_pat(j, sol)) {
-        red_g2.push_back(j);
-      }
+    std::vector<std::size_t> red_s1, red_s2;
+    if (screen_fraction < 1.0) {
+      std::copy_if(red_g1.begin(), red_g1.end(), std::back_inserter(red_s1),
+                   [this](const std::size_t j) { return in_screen[j]; });
+      std::copy_if(red_g2.begin(), red_g2.end(), std::back_inserter(red_s2),
+                   [this](const std::size_t j) { return in_screen[j]; });
     }
 
+    // Sparse bins are counted against the cover of sol instead
+    const std::vector<uint64_t> &cover = prefixes[sol.size()].cover;
+    const uint64_t *grp1 = data.get_grp1_mask().data();
+    const uint64_t *grp2 = data.get_grp2_mask().data();
+
     auto new_sol = sol;
     new_sol.push_back(0);
 
@@ -183,20 +553,36 @@ void GreedyWorker::calc() {
     for (std::size_t i = 0; i < data.get_num_bins(); ++i) {
       // check that i is not in the solution
       if (std::find(sol.begin(), sol.end(), i) == sol.end()) {
+        if (screen_fraction < 1.0 && !passes_screen(i, red_s1, red_s2)) {
+          counters.add(PerfCounters::CANDIDATES);
+          counters.add(PerfCounters::SCREENED_OUT);
+          continue;
+        }
+
         double f1 = 0.0, f2 = 0.0;
 
-        for (auto j : red_g1) {
-          if (data.get_bin(i,j)) {
-            ++f1;
+        if (data.is_sparse(i)) {
+          f1 = data.count_bin(i, cover.data(), grp1);
+        } else {
+          for (auto j : red_g1) {
+            if (data.get_bin(i,j)) {
+              ++f1;
+            }
           }
         }
 
         f1 /= data.get_num_grp1();
+        counters.add(PerfCounters::CANDIDATES);
 
         if (f1 >= min_obj) {
-          for (auto j : red_g2) {
-            if (data.get_bin(i,j)) {
-              ++f2;
+          counters.add(PerfCounters::F1_PASSED);
+          if (data.is_sparse(i)) {
+            f2 = data.count_bin(i, cover.data(), grp2);
+          } else {
+            for (auto j : red_g2) {
+              if (data.get_bin(i,j)) {
+                ++f2;
+              }
             }
           }
           f2 /= data.get_num_grp2();
@@ -205,12 +591,7 @@ void GreedyWorker::calc() {
 
           if (obj >= min_obj) {
             new_sol[new_sol.size()-1] = i;
-            sol_pool.add_solution(obj, new_sol);
-
-            if (sol_pool.size() == sol_pool.get_max_size() &&
-                sol_pool.get_min_obj() > min_obj) {
-              min_obj =  sol_pool.get_min_obj();
-            }
+            add_solution(f1, f2, new_sol);
           }
         }
       }
@@ -218,6 +599,144 @@ void GreedyWorker::calc() {
   }
 }
 
+//------------------------------------------------------------------------------
+// Extends each parent of the task in turn. The controller sends the parents of
+// whole subtrees sorted by bin, so consecutive parents share their prefixes.
+//------------------------------------------------------------------------------
+void GreedyWorker::calc_subtree() {
+  reset_prefixes();
+  for (std::size_t first = 0; first < parents.size(); first += parent_size) {
+    sol = Pattern(parents.begin() + first, parents.begin() + first + parent_size);
+    descend(sol);
+    calc();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Receives the parent patterns of the level and extends the ones handed out by
+// a WorkQueue, stealing from other workers once this rank's share is done.
+// The pool is kept across tasks so min_obj keeps rising over the whole level.
+//------------------------------------------------------------------------------
+void GreedyWorker::calc_distributed() {
+  double trace_start = tracer.now();
+  counters.start_mpi();
+
+  std::size_t header[2];
+  MPI_Bcast(header, 2, CUSTOM_SIZE_T, 0, MPI_COMM_WORLD);
+  const std::size_t num_pats = header[0];
+  const std::size_t pat_size = header[1];
+  ps = pat_size + 1;
+
+  std::vector<uint32_t> pats(num_pats * pat_size);
+  MPI_Bcast(pats.data(), pats.size(), MPI_UINT32_T, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&min_obj, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  counters.stop_mpi();
+  counters.count_recv(2, CUSTOM_SIZE_T);
+  counters.count_recv(pats.size(), MPI_UINT32_T);
+  counters.count_recv(1, MPI_DOUBLE);
+  tracer.record(Tracer::WAIT, trace_start, tag);
+
+  WorkQueue queue(num_pats);
+  std::size_t task;
+
+  // The parents arrive sorted by bin and each rank's range is contiguous, so
+  // prefixes carry over from one task to the next
+  reset_prefixes();
+  while (queue.next(task)) {
+    sol = Pattern(pats.begin() + task * pat_size, pats.begin() + (task + 1) * pat_size);
+    descend(sol);
+
+    counters.add(PerfCounters::TASKS);
+    trace_start = tracer.now();
+    counters.start_compute();
+    calc();
+    counters.stop_compute();
+    tracer.record(Tracer::COMPUTE, trace_start, task);
+  }
+
+  counters.add(PerfCounters::STEALS, queue.get_num_steals());
+}
+
+//------------------------------------------------------------------------------
+// Finds every pattern of size ps whose smallest bin is 'start' and whose obj
+// is at least min_obj, by depth-first search over increasing bin indices.
+// Only bins that reach min_obj in group 1 on their own are candidates.
+//------------------------------------------------------------------------------
+void GreedyWorker::calc_exact() {
+  const std::size_t num_words = data.get_num_words();
+  const uint64_t *grp1 = data.get_grp1_mask().data();
+  const double num_grp1 = data.get_num_grp1();
+
+  Pattern pat = {start};
+  if (ps == 1) {
+    const double f1 = data.get_grp1_freq(pat);
+    counters.add(PerfCounters::CANDIDATES);
+    if (f1 >= min_obj) {
+      counters.add(PerfCounters::F1_PASSED);
+      const double f2 = data.get_grp2_freq(pat);
+      if (f1 - f2 >= min_obj) {
+        add_solution(f1, f2, pat);
+      }
+    }
+    return;
+  }
+
+  std::vector<uint32_t> cands;
+  for (std::size_t i = start + 1; i < data.get_num_bins(); ++i) {
+    if (data.count_bin(i, grp1) / num_grp1 >= min_obj) {
+      cands.push_back(i);
+    }
+  }
+
+  // covers holds the cover of the first d+1 bins of pat at [d*num_words, (d+1)*num_words)
+  std::vector<uint64_t> covers(ps * num_words, ~static_cast<uint64_t>(0));
+  data.and_bin(start, covers.data());
+
+  extend_exact(covers, cands, pat, 0);
+}
+
+//------------------------------------------------------------------------------
+// Adds every candidate from cands[first] on to pat and recurses until pat has
+// ps bins. A branch is cut as soon as its f1 drops below min_obj, since f1
+// only shrinks as bins are added and obj <= f1.
+//------------------------------------------------------------------------------
+void GreedyWorker::extend_exact(std::vector<uint64_t> &covers, const std::vector<uint32_t> &cands, Pattern &pat,
+                                const std::size_t first) {
+  const std::size_t num_words = data.get_num_words();
+  const uint64_t *grp1 = data.get_grp1_mask().data();
+  const uint64_t *grp2 = data.get_grp2_mask().data();
+  const double num_grp1 = data.get_num_grp1();
+  const double num_grp2 = data.get_num_grp2();
+
+  const std::size_t depth = pat.size() - 1;
+  const uint64_t *parent = &covers[depth * num_words];
+  const std::size_t remaining = ps - pat.size();
+
+  for (std::size_t c = first; c + remaining <= cands.size(); ++c) {
+    const double f1 = data.count_bin(cands[c], parent, grp1) / num_grp1;
+    counters.add(PerfCounters::CANDIDATES);
+    if (f1 < min_obj) {
+      continue;
+    }
+    counters.add(PerfCounters::F1_PASSED);
+
+    pat.push_back(cands[c]);
+    if (remaining == 1) {
+      const double f2 = data.count_bin(cands[c], parent, grp2) / num_grp2;
+      if (f1 - f2 >= min_obj) {
+        add_solution(f1, f2, pat);
+      }
+    } else {
+      uint64_t *child = &covers[(depth + 1) * num_words];
+      std::copy(parent, parent + num_words, child);
+      data.and_bin(cands[c], child);
+      extend_exact(covers, cands, pat, c + 1);
+    }
+    pat.pop_back();
+  }
+}
+
 FILE* GreedyWorker::open_file(const std::string &file_name) const {
   FILE *stream;
   if ((stream = fopen(file_name.c_str(), "a+")) == nullptr) {
@@ -245,18 +764,109 @@ bool GreedyWorker::end() const {
 void GreedyWorker::work() {
   receive_problem();
   if (end_) {
+    tracer.write(0);
     return;
   }
 
-  sol_pool.clear();
+  if (tag == Parallel::STATS_TAG) {
+    report_counters();
+    return;
+  }
+
+  if (tag == Parallel::RUN_TAG) {
+    return;
+  }
+
+  if (tag == Parallel::FLUSH_TAG) {
+    reduce_pool();
+    sol_pool.clear();
+    mirror_pool.clear();
+    return;
+  }
+
+  if (tag == Parallel::DISTRIBUTED_TAG) {
+    sol_pool.clear();
+    calc_distributed();
+    reduce_pool();
+    return;
+  }
+
+  // A worker pool lives for the whole level and keeps its threshold between
+  // tasks
+  if (worker_pools) {
+    raise_min_obj();
+  } else {
+    sol_pool.clear();
+    mirror_pool.clear();
+  }
+
+  counters.add(PerfCounters::TASKS);
+  const double trace_start = tracer.now();
+  counters.start_compute();
 
   if (tag == Parallel::PS1_TAG) {
     calc_ps1();
   } else if (tag == Parallel::PS2_TAG) {
     calc_ps2();
+  } else if (tag == Parallel::EXACT_TAG) {
+    calc_exact();
   } else {
-    calc();
+    calc_subtree();
   }
 
+  counters.stop_compute();
+  tracer.record(Tracer::COMPUTE, trace_start, counters.get(PerfCounters::TASKS));
   send_back_solution();
 }
+
+
+//------------------------------------------------------------------------------
+// Runs the PS2 task for marker on this rank without communicating with the
+// controller. Used by the benchmarks.
+//------------------------------------------------------------------------------
+void GreedyWorker::run_ps2_task(const std::size_t marker, const double _min_obj) {
+  start = marker;
+  min_obj = _min_obj;
+  sol_pool.clear();
+  calc_ps2();
+}
+
+//------------------------------------------------------------------------------
+// Extends pat by one bin on this rank without communicating with the
+// controller. Used by the benchmarks.
+//------------------------------------------------------------------------------
+void GreedyWorker::run_task(const Pattern &pat, const double _min_obj) {
+  sol = pat;
+  min_obj = _min_obj;
+  sol_pool.clear();
+  reset_prefixes();
+  descend(sol);
+  calc();
+}
+
+//------------------------------------------------------------------------------
+// Extends each of pats, sorted by bin, by one bin into a single pool on this
+// rank without communicating with the controller. Used by the benchmarks.
+//------------------------------------------------------------------------------
+void GreedyWorker::run_subtree_task(const std::vector<Pattern> &pats, const double _min_obj) {
+  min_obj = _min_obj;
+  sol_pool.clear();
+  parent_size = pats.empty() ? 0 : pats[0].size();
+  parents.clear();
+  for (auto &p : pats) {
+    parents.insert(parents.end(), p.begin(), p.end());
+  }
+  calc_subtree();
+}
+
+//------------------------------------------------------------------------------
+// Runs the exact search below first_bin on this rank without communicating
+// with the controller. Used by the benchmarks.
+//------------------------------------------------------------------------------
+void GreedyWorker::run_exact_task(const std::size_t first_bin, const std::size_t size, const double _min_obj) {
+  start = first_bin;
+  ps = size;
+  min_obj = _min_obj;
+  sol_pool.clear();
+  calc_exact();
+}
\ No newline at end of file
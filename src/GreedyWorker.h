@@ -5,31 +5,85 @@
 #include <string>
 #include "ConfigParser.h"
 #include "ExprsData.h"
+#include "Run.h"
 #include "SolPool.h"
+#include "PerfCounters.h"
+#include "Tracer.h"
 
 class GreedyWorker {
   private:
+    // The cover of the first d bins of the current parent, and the individuals
+    // of each group that have them
+    struct Prefix {
+      std::vector<uint64_t> cover;
+      std::vector<std::size_t> red_g1;
+      std::vector<std::size_t> red_g2;
+    };
+
     const ConfigParser *parser;
-    const ExprsData data;
-    const std::string scratch_dir;
+    ExprsData data;
+    const std::vector<Run> runs;
+    std::string scratch_dir;
     const std::size_t world_rank;
+    const bool worker_pools;
+    const double screen_fraction;
+    const double screen_error;
     int tag;
 
     std::size_t start;
     std::size_t stop;
+    std::size_t ps;
     double min_obj;
-    std::vector<std::size_t> sol;
+    Pattern sol;
+    std::size_t parent_size;
+    std::vector<uint32_t> parents;
+
+    // prefixes[d] belongs to the first d bins of prefix_pat, so parents sorted
+    // by bin share the work on their common prefix
+    std::vector<Prefix> prefixes;
+    Pattern prefix_pat;
+
+    std::vector<char> in_screen;
+    double screen_size[2];
+    double screen_margin[2];
+
+    // With RISK both, PS1 and PS2 tasks may also fill the pool of the mirror
+    // run (Run::get_mirror), whose group 1 is this run's group 2
+    bool mirror;
+    double mirror_min_obj;
+    std::string mirror_dir;
 
     SolPool sol_pool;
+    SolPool mirror_pool;
+    PerfCounters counters;
+    Tracer tracer;
   
     bool end_;
 
     void receive_problem();
+    void receive_mirror(const int tag);
     void send_back_solution();
+    void send_pool(const SolPool &pool);
+    void reduce_pool();
+    void report_counters();
+    void add_solution(const double f1, const double f2, const Pattern &pat);
+    void add_mirror_solution(const double f1, const double f2, const Pattern &pat);
+    void raise_min_obj();
+
+    void build_screen_sample();
+    bool passes_screen(const std::size_t bin, const std::vector<std::size_t> &red_s1,
+                       const std::vector<std::size_t> &red_s2) const;
 
     void calc_ps1();
     void calc_ps2();
+    void reset_prefixes();
+    void descend(const Pattern &pat);
     void calc();
+    void calc_subtree();
+    void calc_distributed();
+    void calc_exact();
+    void extend_exact(std::vector<uint64_t> &covers, const std::vector<uint32_t> &cands, Pattern &pat,
+                      const std::size_t first);
 
     FILE* open_file(const std::string &file_name) const;
     void close_file(FILE *stream) const;
@@ -42,6 +96,11 @@ class GreedyWorker {
     bool end() const;
 
     void work();
+
+    void run_ps2_task(const std::size_t marker, const double _min_obj);
+    void run_task(const Pattern &pat, const double _min_obj);
+    void run_subtree_task(const std::vector<Pattern> &pats, const double _min_obj);
+    void run_exact_task(const std::size_t first_bin, const std::size_t size, const double _min_obj);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "Numa.h"
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <pthread.h>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+  const std::size_t PAGE_WORDS = 4096 / sizeof(uint64_t);
+
+  thread_local std::size_t current_node = 0;
+
+  //----------------------------------------------------------------------------
+  // Parses a sysfs CPU list such as 0-3,8-11
+  //----------------------------------------------------------------------------
+  std::vector<int> parse_cpu_list(const std::string &list) {
+    std::vector<int> cpus;
+    std::istringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+      const std::size_t dash = range.find('-');
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int c = first; c <= last; ++c) {
+        cpus.push_back(c);
+      }
+    }
+    return cpus;
+  }
+
+  //----------------------------------------------------------------------------
+  // CPUs of each node the process may run on, in node order. Falls back to a
+  // single node if the system does not list any.
+  //----------------------------------------------------------------------------
+  std::vector<std::vector<int>> find_nodes() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    std::vector<std::pair<int, std::vector<int>>> found;
+    const std::string base = "/sys/devices/system/node/";
+    if (DIR *dir = opendir(base.c_str())) {
+      while (struct dirent *entry = readdir(dir)) {
+        if (strncmp(entry->d_name, "node", 4) != 0 || !isdigit(entry->d_name[4])) {
+          continue;
+        }
+
+        std::ifstream input(base + entry->d_name + "/cpulist");
+        std::string list;
+        std::vector<int> cpus;
+        if (std::getline(input, list) && !list.empty()) {
+          for (auto c : parse_cpu_list(list)) {
+            if (CPU_ISSET(c, &allowed)) {
+              cpus.push_back(c);
+            }
+          }
+        }
+        if (!cpus.empty()) {
+          found.push_back(std::make_pair(atoi(entry->d_name + 4), cpus));
+        }
+      }
+      closedir(dir);
+    }
+    std::sort(found.begin(), found.end());
+
+    std::vector<std::vector<int>> nodes;
+    for (auto &f : found) {
+      nodes.push_back(f.second);
+    }
+    if (nodes.empty()) {
+      nodes.resize(1);
+      for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, &allowed)) {
+          nodes[0].push_back(c);
+        }
+      }
+    }
+    return nodes;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Converts the NUMA_POLICY config value
+//------------------------------------------------------------------------------
+Numa::Policy Numa::parse_policy(const std::string &str) {
+  if (str == "none") {
+    return NONE;
+  } else if (str == "pin") {
+    return PIN;
+  } else if (str == "interleave") {
+    return INTERLEAVE;
+  } else if (str == "replicate") {
+    return REPLICATE;
+  }
+  throw std::runtime_error("Numa: Unknown NUMA_POLICY '" + str + "'");
+}
+
+const char * Numa::get_policy_name(const Policy policy) {
+  static const char *names[] = {"none", "pin", "interleave", "replicate"};
+  return names[policy];
+}
+
+const std::vector<std::vector<int>> & Numa::get_nodes() {
+  static const std::vector<std::vector<int>> nodes = find_nodes();
+  return nodes;
+}
+
+//------------------------------------------------------------------------------
+// Node the calling thread is pinned to (0 if it is not pinned)
+//------------------------------------------------------------------------------
+std::size_t Numa::get_node() {
+  return current_node;
+}
+
+Numa::Pin::Pin(const std::size_t node) : old_node(current_node) {
+  pthread_getaffinity_np(pthread_self(), sizeof(old_cpus), &old_cpus);
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (auto c : get_nodes()[node]) {
+    CPU_SET(c, &cpus);
+  }
+  pinned = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+  current_node = node;
+}
+
+Numa::Pin::~Pin() {
+  if (pinned) {
+    pthread_setaffinity_np(pthread_self(), sizeof(old_cpus), &old_cpus);
+  }
+  current_node = old_node;
+}
+
+//------------------------------------------------------------------------------
+// Returns the placed copies of words: one per node for replicate, or a single
+// copy whose pages are dealt out to the nodes in turn for interleave. Each
+// node's pages are first written by a thread pinned to it.
+//------------------------------------------------------------------------------
+std::vector<std::shared_ptr<uint64_t>> Numa::place(const uint64_t *words, const std::size_t num_words,
+                                                   const Policy policy) {
+  const std::size_t num_nodes = get_nodes().size();
+  const std::size_t num_copies = policy == REPLICATE ? num_nodes : 1;
+
+  // new[] leaves the pages untouched until the pinned threads write them
+  std::vector<std::shared_ptr<uint64_t>> copies;
+  for (std::size_t k = 0; k < num_copies; ++k) {
+    copies.push_back(std::shared_ptr<uint64_t>(new uint64_t[std::max<std::size_t>(num_words, 1)],
+                                               std::default_delete<uint64_t[]>()));
+  }
+
+  std::vector<std::thread> threads;
+  for (std::size_t node = 0; node < num_nodes; ++node) {
+    threads.push_back(std::thread([&, node]() {
+      Pin pin(node);
+      if (policy == REPLICATE) {
+        std::copy(words, words + num_words, copies[node].get());
+        return;
+      }
+      for (std::size_t first = node * PAGE_WORDS; first < num_words; first += num_nodes * PAGE_WORDS) {
+        const std::size_t last = std::min(num_words, first + PAGE_WORDS);
+        std::copy(words + first, words + last, copies[0].get() + first);
+      }
+    }));
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  return copies;
+}
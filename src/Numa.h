@@ -0,0 +1,50 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <memory>
+#include <sched.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// NUMA placement for the threaded scorers (NUMA_POLICY):
+//
+//   none        threads float and share one task queue (default)
+//   pin         threads are pinned to the nodes in turn and each node has its
+//               own task queue; a node steals from the others once its queue
+//               is empty
+//   interleave  pin, and the bin matrix is spread over the nodes page by page
+//   replicate   pin, and every node gets its own copy of the bin matrix
+//
+// Nodes are read from /sys/devices/system/node and restricted to the CPUs the
+// process may run on, so a rank bound to one socket by mpirun sees one node.
+// Pages are placed by first touch: a thread pinned to a node writes them.
+//------------------------------------------------------------------------------
+namespace Numa {
+  enum Policy {NONE, PIN, INTERLEAVE, REPLICATE};
+
+  Policy parse_policy(const std::string &str);
+  const char * get_policy_name(const Policy policy);
+
+  const std::vector<std::vector<int>> & get_nodes();
+  std::size_t get_node();
+
+  // Pins the calling thread to a node for the lifetime of the object and
+  // restores its previous CPUs and node afterwards
+  class Pin {
+    private:
+      cpu_set_t old_cpus;
+      std::size_t old_node;
+      bool pinned;
+
+    public:
+      Pin(const std::size_t node);
+      ~Pin();
+  };
+
+  std::vector<std::shared_ptr<uint64_t>> place(const uint64_t *words, const std::size_t num_words,
+                                               const Policy policy);
+}
+
+#endif
@@ -26,6 +26,14 @@ namespace Parallel {
   const int PS1_TAG = 1;
   const int PS2_TAG = 2;
   const int GREEDY_TAG = 3;
+  const int STATS_TAG = 4;
+  const int DISTRIBUTED_TAG = 5;
+  const int STEAL_REQUEST_TAG = 6;
+  const int STEAL_REPLY_TAG = 7;
+  const int FLUSH_TAG = 8;
+  const int EXACT_TAG = 9;
+  const int RUN_TAG = 10;
+  const int ESTIMATE_TAG = 11;
 
   int get_world_rank();
   int get_world_size();
@@ -0,0 +1,99 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <stdint.h>
+
+// Largest pattern size a build can handle (override with -DMAX_PATTERN_SIZE=N)
+#ifndef MAX_PATTERN_SIZE
+  #define MAX_PATTERN_SIZE 12
+#endif
+
+//------------------------------------------------------------------------------
+// Pattern of up to N bin indices stored inline as uint32_t, so copying a
+// pattern never allocates. Offers the parts of the std::vector interface the
+// solver uses; elements are contiguous, so &pat[0] can be passed to MPI as
+// MPI_UINT32_T.
+//------------------------------------------------------------------------------
+template<std::size_t N>
+class InlinePattern {
+  private:
+    uint32_t bins[N];
+    uint32_t len;
+
+  public:
+    typedef uint32_t value_type;
+    typedef uint32_t *iterator;
+    typedef const uint32_t *const_iterator;
+
+    InlinePattern() : len(0) {}
+
+    InlinePattern(const std::size_t n, const std::size_t value = 0) : len(n) {
+      assert(n <= N);
+      std::fill(bins, bins + n, value);
+    }
+
+    InlinePattern(std::initializer_list<std::size_t> list) : len(0) {
+      for (auto b : list) {
+        push_back(b);
+      }
+    }
+
+    template<typename It>
+    InlinePattern(It first, It last) : len(0) {
+      for (; first != last; ++first) {
+        push_back(*first);
+      }
+    }
+
+    static std::size_t max_size() { return N; }
+
+    std::size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    uint32_t &operator[](const std::size_t i) { return bins[i]; }
+    const uint32_t &operator[](const std::size_t i) const { return bins[i]; }
+    uint32_t &back() { return bins[len - 1]; }
+    const uint32_t &back() const { return bins[len - 1]; }
+
+    iterator begin() { return bins; }
+    iterator end() { return bins + len; }
+    const_iterator begin() const { return bins; }
+    const_iterator end() const { return bins + len; }
+
+    void push_back(const std::size_t bin) {
+      assert(len < N);
+      bins[len++] = bin;
+    }
+
+    void pop_back() { --len; }
+
+    void resize(const std::size_t n, const std::size_t value = 0) {
+      assert(n <= N);
+      if (n > len) {
+        std::fill(bins + len, bins + n, value);
+      }
+      len = n;
+    }
+
+    void clear() { len = 0; }
+
+    bool operator==(const InlinePattern &other) const {
+      return len == other.len && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const InlinePattern &other) const {
+      return !(*this == other);
+    }
+
+    bool operator<(const InlinePattern &other) const {
+      return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+    }
+};
+
+typedef InlinePattern<MAX_PATTERN_SIZE> Pattern;
+
+#endif
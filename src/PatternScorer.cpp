@@ -0,0 +1,107 @@
+#include "PatternScorer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Threads.h"
+
+PatternScorer::PatternScorer(const ExprsData &_data, const std::size_t _num_threads) : data(&_data),
+                                                                                       num_threads(_num_threads > 0 ? _num_threads : 1) {}
+
+PatternScorer::~PatternScorer() {}
+
+//------------------------------------------------------------------------------
+// Reads a file with one pattern per line, given as space separated bin
+// indices. Lines are parsed in parallel.
+//------------------------------------------------------------------------------
+std::vector<Pattern> PatternScorer::read_patterns(const std::string &file_name) const {
+  FILE *input;
+  if ((input = fopen(file_name.c_str(), "rb")) == nullptr) {
+    fprintf(stderr, "ERROR - PatternScorer::read_patterns - Could not open file (%s)\n", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  std::string buffer;
+  char chunk[1 << 16];
+  std::size_t num_read;
+  while ((num_read = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+    buffer.append(chunk, num_read);
+  }
+  fclose(input);
+
+  // Find the start of every non-empty line
+  std::vector<std::size_t> line_start;
+  std::size_t pos = 0;
+  while (pos < buffer.size()) {
+    const std::size_t eol = std::min(buffer.find('\n', pos), buffer.size());
+    if (eol > pos) {
+      line_start.push_back(pos);
+    }
+    pos = eol + 1;
+  }
+
+  std::vector<Pattern> pats(line_start.size());
+  const std::size_t num_bins = data->get_num_bins();
+
+  Threads::parallel_for(pats.size(), BATCH_SIZE, num_threads, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const char *str = buffer.c_str() + line_start[i];
+      char *str_end;
+
+      while (*str != '\n' && *str != '\0') {
+        const std::size_t bin = strtoul(str, &str_end, 10);
+        if (str_end == str) {
+          break;
+        }
+        if (pats[i].size() == Pattern::max_size()) {
+          fprintf(stderr, "ERROR - PatternScorer::read_patterns - Line %lu of %s has more than %lu bins\n",
+                  i + 1, file_name.c_str(), Pattern::max_size());
+          exit(EXIT_FAILURE);
+        }
+        if (bin >= num_bins) {
+          fprintf(stderr, "ERROR - PatternScorer::read_patterns - Bin %lu on line %lu of %s is out of range\n",
+                  bin, i + 1, file_name.c_str());
+          exit(EXIT_FAILURE);
+        }
+        pats[i].push_back(bin);
+        str = str_end;
+        while (*str == ' ' || *str == '\t' || *str == '\r') {
+          ++str;
+        }
+      }
+    }
+  });
+
+  return pats;
+}
+
+//------------------------------------------------------------------------------
+// Returns f1, f2 and obj for every pattern, in the order given
+//------------------------------------------------------------------------------
+std::vector<Solution> PatternScorer::score(const std::vector<Pattern> &pats) const {
+  return score(pats, 0, pats.size());
+}
+
+//------------------------------------------------------------------------------
+// Returns f1, f2 and obj for the patterns in [begin, end)
+//------------------------------------------------------------------------------
+std::vector<Solution> PatternScorer::score(const std::vector<Pattern> &pats,
+                                           const std::size_t begin, const std::size_t end) const {
+  std::vector<Solution> sols(end - begin);
+  const double num_grp1 = data->get_num_grp1();
+  const double num_grp2 = data->get_num_grp2();
+
+  Threads::parallel_for(sols.size(), BATCH_SIZE, num_threads, data->get_numa_policy(),
+                        [&](std::size_t b, std::size_t e) {
+    std::vector<uint64_t> cover;
+    for (std::size_t i = b; i < e; ++i) {
+      const Pattern &pat = pats[begin + i];
+      data->get_cover(pat, cover);
+
+      sols[i] = Solution(data->count_in_mask(cover, data->get_grp1_mask()) / num_grp1,
+                         data->count_in_mask(cover, data->get_grp2_mask()) / num_grp2,
+                         pat);
+    }
+  });
+
+  return sols;
+}
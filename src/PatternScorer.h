@@ -0,0 +1,30 @@
+#ifndef PATTERN_SCORER_H
+#define PATTERN_SCORER_H
+
+#include <string>
+#include <vector>
+#include "ExprsData.h"
+#include "Solution.h"
+
+// Parses and scores many patterns at once. Work is split into batches that are
+// spread over num_threads threads, and each pattern is scored with packed
+// AND/popcount over the bin bitsets.
+class PatternScorer {
+  private:
+    const ExprsData *data;
+    const std::size_t num_threads;
+
+    static const std::size_t BATCH_SIZE = 256;
+
+  public:
+    PatternScorer(const ExprsData &_data, const std::size_t _num_threads);
+    ~PatternScorer();
+
+    std::vector<Pattern> read_patterns(const std::string &file_name) const;
+
+    std::vector<Solution> score(const std::vector<Pattern> &pats) const;
+    std::vector<Solution> score(const std::vector<Pattern> &pats,
+                                const std::size_t begin, const std::size_t end) const;
+};
+
+#endif
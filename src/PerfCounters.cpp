@@ -0,0 +1,122 @@
+#include "PerfCounters.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+  const char *FIELD_NAMES[PerfCounters::NUM_FIELDS] = {"tasks", "candidates", "f1_passed", "screened_out",
+                                                       "pool_inserts", "pool_rejects", "steals", "bytes_sent", "bytes_recv",
+                                                       "compute_time", "mpi_time"};
+}
+
+PerfCounters::PerfCounters() : values(NUM_FIELDS, 0.0),
+                               compute_start(0.0),
+                               mpi_start(0.0) {}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::reset() {
+  std::fill(values.begin(), values.end(), 0.0);
+}
+
+void PerfCounters::add(const Field field, const double amount) {
+  values[field] += amount;
+}
+
+double PerfCounters::get(const Field field) const {
+  return values[field];
+}
+
+void PerfCounters::count_sent(const int count, MPI_Datatype type) {
+  int size;
+  MPI_Type_size(type, &size);
+  values[BYTES_SENT] += static_cast<double>(count) * size;
+}
+
+void PerfCounters::count_recv(const int count, MPI_Datatype type) {
+  int size;
+  MPI_Type_size(type, &size);
+  values[BYTES_RECV] += static_cast<double>(count) * size;
+}
+
+void PerfCounters::start_compute() {
+  compute_start = MPI_Wtime();
+}
+
+void PerfCounters::stop_compute() {
+  values[COMPUTE_TIME] += MPI_Wtime() - compute_start;
+}
+
+void PerfCounters::start_mpi() {
+  mpi_start = MPI_Wtime();
+}
+
+void PerfCounters::stop_mpi() {
+  values[MPI_TIME] += MPI_Wtime() - mpi_start;
+}
+
+//------------------------------------------------------------------------------
+// Collective over MPI_COMM_WORLD. Returns the counters of every rank, rank
+// major, on root and an empty vector elsewhere.
+//------------------------------------------------------------------------------
+std::vector<double> PerfCounters::gather(const int root) const {
+  int world_rank, world_size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+  std::vector<double> all_values(world_rank == root ? NUM_FIELDS * world_size : 0);
+  MPI_Gather(values.data(), NUM_FIELDS, MPI_DOUBLE, all_values.data(), NUM_FIELDS, MPI_DOUBLE, root,
+             MPI_COMM_WORLD);
+  return all_values;
+}
+
+//------------------------------------------------------------------------------
+// Writes the per-rank counters of a level along with their totals and the
+// min/max/mean over the worker ranks
+//------------------------------------------------------------------------------
+void PerfCounters::write_json(const std::string &file_name, const std::size_t ps, const double wall_time,
+                              const std::vector<double> &all_values) {
+  FILE *output;
+  if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - PerfCounters::write_json - Could not open file %s\n", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  const std::size_t num_ranks = all_values.size() / NUM_FIELDS;
+
+  fprintf(output, "{\n  \"ps\": %lu,\n  \"wall_time\": %.6f,\n  \"ranks\": [\n", ps, wall_time);
+  for (std::size_t r = 0; r < num_ranks; ++r) {
+    fprintf(output, "    {\"rank\": %lu", r);
+    for (std::size_t f = 0; f < NUM_FIELDS; ++f) {
+      fprintf(output, f < COMPUTE_TIME ? ", \"%s\": %.0f" : ", \"%s\": %.6f", FIELD_NAMES[f],
+              all_values[r * NUM_FIELDS + f]);
+    }
+    fprintf(output, r + 1 < num_ranks ? "},\n" : "}\n");
+  }
+  fprintf(output, "  ],\n");
+
+  const char *stat_names[4] = {"total", "worker_min", "worker_max", "worker_mean"};
+  for (std::size_t k = 0; k < 4; ++k) {
+    fprintf(output, "  \"%s\": {", stat_names[k]);
+    for (std::size_t f = 0; f < NUM_FIELDS; ++f) {
+      double total = all_values[f];
+      double worker_min = 0.0, worker_max = 0.0, worker_total = 0.0;
+      for (std::size_t r = 1; r < num_ranks; ++r) {
+        const double v = all_values[r * NUM_FIELDS + f];
+        worker_min = (r == 1) ? v : std::min(worker_min, v);
+        worker_max = (r == 1) ? v : std::max(worker_max, v);
+        worker_total += v;
+      }
+      total += worker_total;
+
+      const double stat[4] = {total, worker_min, worker_max,
+                              num_ranks > 1 ? worker_total / (num_ranks - 1) : 0.0};
+      fprintf(output, (f < COMPUTE_TIME && k < 3) ? "%s\"%s\": %.0f" : "%s\"%s\": %.6f",
+              f > 0 ? ", " : "", FIELD_NAMES[f], stat[k]);
+    }
+    fprintf(output, k + 1 < 4 ? "},\n" : "}\n");
+  }
+  fprintf(output, "}\n");
+
+  fclose(output);
+}
@@ -0,0 +1,41 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+// Work and communication counters kept by every rank for the current level
+class PerfCounters {
+  public:
+    enum Field {TASKS, CANDIDATES, F1_PASSED, SCREENED_OUT, POOL_INSERTS, POOL_REJECTS, STEALS, BYTES_SENT, BYTES_RECV,
+                COMPUTE_TIME, MPI_TIME, NUM_FIELDS};
+
+  private:
+    std::vector<double> values;
+    double compute_start;
+    double mpi_start;
+
+  public:
+    PerfCounters();
+    ~PerfCounters();
+
+    void reset();
+    void add(const Field field, const double amount = 1.0);
+    double get(const Field field) const;
+
+    void count_sent(const int count, MPI_Datatype type);
+    void count_recv(const int count, MPI_Datatype type);
+
+    void start_compute();
+    void stop_compute();
+    void start_mpi();
+    void stop_mpi();
+
+    std::vector<double> gather(const int root) const;
+
+    static void write_json(const std::string &file_name, const std::size_t ps, const double wall_time,
+                           const std::vector<double> &all_values);
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "PermutationTester.h"
+#include <algorithm>
+#include <random>
+#include "Threads.h"
+#include "Utils.h"
+
+const std::size_t PermutationTester::MASK_BATCH;
+
+PermutationTester::PermutationTester(const ExprsData &_data, const std::size_t _num_threads,
+                                     const uint64_t _seed) : data(&_data),
+                                                             num_threads(_num_threads > 0 ? _num_threads : 1),
+                                                             seed(_seed) {
+  all_mask.resize(data->get_num_words());
+  for (std::size_t w = 0; w < all_mask.size(); ++w) {
+    all_mask[w] = data->get_grp1_mask()[w] | data->get_grp2_mask()[w];
+  }
+
+  for (std::size_t j = 0; j < 64 * all_mask.size(); ++j) {
+    if ((all_mask[j / 64] >> (j % 64)) & 1) {
+      indivs.push_back(j);
+    }
+  }
+}
+
+PermutationTester::~PermutationTester() {}
+
+//------------------------------------------------------------------------------
+// Builds the group 1 masks of permutations [first, first+num), interleaved so
+// word w of mask k is masks[w*num + k]
+//------------------------------------------------------------------------------
+void PermutationTester::make_masks(const std::size_t first, const std::size_t num,
+                                   std::vector<uint64_t> &masks) const {
+  const std::size_t num_words = data->get_num_words();
+  masks.assign(num_words * num, 0);
+
+  std::vector<std::size_t> order;
+  for (std::size_t k = 0; k < num; ++k) {
+    std::seed_seq seq{seed, static_cast<uint64_t>(first + k)};
+    std::mt19937_64 rng(seq);
+
+    // Partial Fisher-Yates: only the first num_grp1 picks are needed
+    order = indivs;
+    for (std::size_t i = 0; i < data->get_num_grp1(); ++i) {
+      std::swap(order[i], order[std::uniform_int_distribution<std::size_t>(i, order.size() - 1)(rng)]);
+      masks[(order[i] / 64) * num + k] |= static_cast<uint64_t>(1) << (order[i] % 64);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Rescores the observed patterns under permutations [first, last). Adds to
+// num_exceeding[i] the number of permutations in which pattern i reaches its
+// observed obj, and sets max_obj[k - first] to the largest obj of any pattern
+// under permutation k. Patterns are spread over the threads.
+//------------------------------------------------------------------------------
+void PermutationTester::run(const std::vector<Solution> &observed, const std::size_t first,
+                            const std::size_t last, std::vector<uint64_t> &num_exceeding,
+                            std::vector<double> &max_obj) const {
+  const std::size_t num_words = data->get_num_words();
+  const double num_grp1 = data->get_num_grp1();
+  const double num_grp2 = data->get_num_grp2();
+
+  num_exceeding.resize(observed.size(), 0);
+  max_obj.assign(last - first, -1.0);
+
+  std::vector<uint64_t> masks;
+  std::vector<double> objs;
+
+  for (std::size_t batch = first; batch < last; batch += MASK_BATCH) {
+    const std::size_t num = std::min(MASK_BATCH, last - batch);
+    make_masks(batch, num, masks);
+    objs.assign(observed.size() * num, 0.0);
+
+    Threads::parallel_for(observed.size(), BATCH_SIZE, num_threads, data->get_numa_policy(),
+                          [&](std::size_t b, std::size_t e) {
+      std::vector<uint64_t> cover;
+      std::size_t counts[MASK_BATCH];
+
+      for (std::size_t i = b; i < e; ++i) {
+        data->get_cover(observed[i].pat, cover);
+        const std::size_t total = data->count_in_mask(cover, all_mask);
+
+        // One pass over the cover counts it against every mask of the batch
+        std::fill(counts, counts + num, 0);
+        for (std::size_t w = 0; w < num_words; ++w) {
+          const uint64_t c = cover[w];
+          const uint64_t *m = &masks[w * num];
+          for (std::size_t k = 0; k < num; ++k) {
+            counts[k] += utils::popcount(c & m[k]);
+          }
+        }
+
+        for (std::size_t k = 0; k < num; ++k) {
+          const double obj = counts[k] / num_grp1 - (total - counts[k]) / num_grp2;
+          objs[i * num + k] = obj;
+          if (obj >= observed[i].obj) {
+            ++num_exceeding[i];
+          }
+        }
+      }
+    });
+
+    for (std::size_t i = 0; i < observed.size(); ++i) {
+      for (std::size_t k = 0; k < num; ++k) {
+        max_obj[batch - first + k] = std::max(max_obj[batch - first + k], objs[i * num + k]);
+      }
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef PERMUTATION_TESTER_H
+#define PERMUTATION_TESTER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ExprsData.h"
+#include "Solution.h"
+
+// Rescores patterns under random relabelings of the individuals to get
+// empirical p-values for their obj. Permutation k shuffles the group labels of
+// the individuals of both groups, keeping the group sizes, with a generator
+// seeded from (seed, k), so any range of permutations gives the same masks on
+// any rank. The bin bitsets are never touched: each permutation is a packed
+// group 1 mask, and a batch of masks is counted against a pattern's cover in
+// one pass over its words.
+class PermutationTester {
+  private:
+    const ExprsData *data;
+    const std::size_t num_threads;
+    const uint64_t seed;
+    std::vector<uint64_t> all_mask;
+    std::vector<std::size_t> indivs;
+
+    static const std::size_t MASK_BATCH = 32;
+    static const std::size_t BATCH_SIZE = 64;
+
+    void make_masks(const std::size_t first, const std::size_t num, std::vector<uint64_t> &masks) const;
+
+  public:
+    PermutationTester(const ExprsData &_data, const std::size_t _num_threads, const uint64_t _seed);
+    ~PermutationTester();
+
+    void run(const std::vector<Solution> &observed, const std::size_t first, const std::size_t last,
+             std::vector<uint64_t> &num_exceeding, std::vector<double> &max_obj) const;
+};
+
+#endif
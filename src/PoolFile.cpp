@@ -0,0 +1,137 @@
+#include "PoolFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+namespace {
+  const char MAGIC[4] = {'S', 'G', 'P', 'L'};
+
+  void write_or_die(const void *buf, const std::size_t size, const std::size_t count, FILE *stream,
+                    const std::string &file_name) {
+    if (fwrite(buf, size, count, stream) != count) {
+      fprintf(stderr, "ERROR - PoolFile - Could not write to file %s\n", file_name.c_str());
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  void read_or_die(void *buf, const std::size_t size, const std::size_t count, FILE *stream,
+                   const std::string &file_name) {
+    if (fread(buf, size, count, stream) != count) {
+      fprintf(stderr, "ERROR - PoolFile - Unexpected end of file %s\n", file_name.c_str());
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes the solutions, including f1, f2 and obj, in the binary pool format
+//------------------------------------------------------------------------------
+void PoolFile::write_binary(const std::string &file_name, const std::vector<Solution> &sols) {
+  FILE *output;
+  if ((output = fopen(file_name.c_str(), "wb")) == nullptr) {
+    fprintf(stderr, "ERROR - PoolFile::write_binary - Could not open file %s\n", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  write_stream(output, sols, file_name);
+
+  fclose(output);
+}
+
+//------------------------------------------------------------------------------
+// Writes the binary pool format at the current position of an open stream.
+// file_name is only used for error messages.
+//------------------------------------------------------------------------------
+void PoolFile::write_stream(FILE *output, const std::vector<Solution> &sols, const std::string &file_name) {
+  const uint32_t header[3] = {static_cast<uint32_t>(VERSION),
+                              static_cast<uint32_t>(sols.empty() ? 0 : sols[0].pat.size()),
+                              0};
+  const uint64_t num_sols = sols.size();
+
+  write_or_die(MAGIC, sizeof(char), 4, output, file_name);
+  write_or_die(header, sizeof(uint32_t), 3, output, file_name);
+  write_or_die(&num_sols, sizeof(uint64_t), 1, output, file_name);
+
+  for (auto &s : sols) {
+    const double vals[3] = {s.obj, s.f1, s.f2};
+    write_or_die(vals, sizeof(double), 3, output, file_name);
+    write_or_die(s.pat.begin(), sizeof(uint32_t), header[1], output, file_name);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes the bin indices of each solution as space separated text, one
+// solution per line
+//------------------------------------------------------------------------------
+void PoolFile::write_text(const std::string &file_name, const std::vector<Solution> &sols) {
+  FILE *output;
+  if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - PoolFile::write_text - Could not open file %s\n", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  for (auto &s : sols) {
+    for (std::size_t i = 0; i < s.pat.size(); ++i) {
+      fprintf(output, i + 1 < s.pat.size() ? "%u " : "%u", s.pat[i]);
+    }
+    fprintf(output, "\n");
+  }
+
+  fclose(output);
+}
+
+//------------------------------------------------------------------------------
+// Reads a file written by write_binary
+//------------------------------------------------------------------------------
+std::vector<Solution> PoolFile::read_binary(const std::string &file_name) {
+  FILE *input;
+  if ((input = fopen(file_name.c_str(), "rb")) == nullptr) {
+    fprintf(stderr, "ERROR - PoolFile::read_binary - Could not open file %s\n", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<Solution> sols = read_stream(input, file_name);
+
+  fclose(input);
+  return sols;
+}
+
+//------------------------------------------------------------------------------
+// Reads the binary pool format from the current position of an open stream
+//------------------------------------------------------------------------------
+std::vector<Solution> PoolFile::read_stream(FILE *input, const std::string &file_name) {
+  char magic[4];
+  uint32_t header[3];
+  uint64_t num_sols;
+
+  read_or_die(magic, sizeof(char), 4, input, file_name);
+  read_or_die(header, sizeof(uint32_t), 3, input, file_name);
+  read_or_die(&num_sols, sizeof(uint64_t), 1, input, file_name);
+
+  if (memcmp(magic, MAGIC, 4) != 0 || header[0] != VERSION) {
+    fprintf(stderr, "ERROR - PoolFile::read_stream - %s is not a version %lu pool file\n",
+            file_name.c_str(), VERSION);
+    exit(EXIT_FAILURE);
+  }
+
+  if (header[1] > Pattern::max_size()) {
+    fprintf(stderr, "ERROR - PoolFile::read_stream - Patterns of size %u in %s exceed MAX_PATTERN_SIZE (%lu)\n",
+            header[1], file_name.c_str(), Pattern::max_size());
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<Solution> sols(num_sols);
+  for (auto &s : sols) {
+    double vals[3];
+    read_or_die(vals, sizeof(double), 3, input, file_name);
+    s.pat.resize(header[1]);
+    read_or_die(s.pat.begin(), sizeof(uint32_t), header[1], input, file_name);
+
+    s.obj = vals[0];
+    s.f1 = vals[1];
+    s.f2 = vals[2];
+  }
+
+  return sols;
+}
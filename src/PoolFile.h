@@ -0,0 +1,34 @@
+#ifndef POOL_FILE_H
+#define POOL_FILE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Solution.h"
+
+//------------------------------------------------------------------------------
+// Binary solution pool format (host byte order)
+//
+//   header:  char[4]  magic "SGPL"
+//            uint32   version
+//            uint32   pattern size (ps)
+//            uint32   reserved
+//            uint64   number of solutions
+//   record:  double   obj
+//            double   f1
+//            double   f2
+//            uint32   bin index (x ps)
+//------------------------------------------------------------------------------
+namespace PoolFile {
+  const std::size_t VERSION = 1;
+
+  void write_binary(const std::string &file_name, const std::vector<Solution> &sols);
+  void write_text(const std::string &file_name, const std::vector<Solution> &sols);
+
+  std::vector<Solution> read_binary(const std::string &file_name);
+
+  void write_stream(FILE *output, const std::vector<Solution> &sols, const std::string &file_name);
+  std::vector<Solution> read_stream(FILE *input, const std::string &file_name);
+}
+
+#endif
@@ -0,0 +1,125 @@
+#include "PoolReduce.h"
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <stdint.h>
+
+namespace {
+  const std::size_t HEADER_WORDS = 3;
+
+  // obj, f1 and f2 followed by the uint32_t bin indices, padded to whole words
+  std::size_t get_record_words(const std::size_t ps) {
+    return 3 + (ps + 1) / 2;
+  }
+
+  double get_obj(const uint64_t *record) {
+    double obj;
+    memcpy(&obj, record, sizeof(double));
+    return obj;
+  }
+
+  //----------------------------------------------------------------------------
+  // Merges the sorted pools a and b into b, keeping at most K records. Records
+  // of a come first among equal obj values.
+  //----------------------------------------------------------------------------
+  void merge_pools(const uint64_t *a, uint64_t *b) {
+    const std::size_t num_a = a[0];
+    const std::size_t num_b = b[0];
+    const std::size_t ps = b[1];
+    const std::size_t max_size = b[2];
+    const std::size_t rec = get_record_words(ps);
+
+    const uint64_t *rec_a = a + HEADER_WORDS;
+    const uint64_t *rec_b = b + HEADER_WORDS;
+    std::vector<uint64_t> merged;
+    merged.reserve(max_size * rec);
+    std::set<std::vector<uint64_t>> seen;
+
+    std::size_t i = 0, j = 0, num_merged = 0;
+    while (num_merged < max_size && (i < num_a || j < num_b)) {
+      const uint64_t *r;
+      if (j == num_b || (i < num_a && get_obj(rec_a + i * rec) >= get_obj(rec_b + j * rec))) {
+        r = rec_a + (i++) * rec;
+      } else {
+        r = rec_b + (j++) * rec;
+      }
+
+      if (seen.insert(std::vector<uint64_t>(r + 3, r + rec)).second) {
+        merged.insert(merged.end(), r, r + rec);
+        ++num_merged;
+      }
+    }
+
+    b[0] = num_merged;
+    std::copy(merged.begin(), merged.end(), b + HEADER_WORDS);
+  }
+
+  void merge_op(void *in, void *inout, int *len, MPI_Datatype *) {
+    const uint64_t *a = static_cast<const uint64_t *>(in);
+    uint64_t *b = static_cast<uint64_t *>(inout);
+    const std::size_t words = HEADER_WORDS + b[2] * get_record_words(b[1]);
+
+    for (int e = 0; e < *len; ++e) {
+      merge_pools(a + e * words, b + e * words);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Size in bytes of one packed pool
+//------------------------------------------------------------------------------
+std::size_t PoolReduce::get_buffer_size(const std::size_t ps, const std::size_t max_size) {
+  return sizeof(uint64_t) * (HEADER_WORDS + max_size * get_record_words(ps));
+}
+
+//------------------------------------------------------------------------------
+// Collective over MPI_COMM_WORLD. sols must be sorted by decreasing obj and
+// hold at most max_size solutions of size ps. Returns the merged pool on root
+// and an empty vector elsewhere.
+//------------------------------------------------------------------------------
+std::vector<Solution> PoolReduce::reduce(const std::vector<Solution> &sols, const std::size_t ps,
+                                         const std::size_t max_size, const int root) {
+  const std::size_t rec = get_record_words(ps);
+  std::vector<uint64_t> local(HEADER_WORDS + max_size * rec, 0);
+  local[0] = std::min(sols.size(), max_size);
+  local[1] = ps;
+  local[2] = max_size;
+
+  for (std::size_t i = 0; i < local[0]; ++i) {
+    uint64_t *r = &local[HEADER_WORDS + i * rec];
+    const double vals[3] = {sols[i].obj, sols[i].f1, sols[i].f2};
+    memcpy(r, vals, sizeof(vals));
+    memcpy(r + 3, sols[i].pat.begin(), ps * sizeof(uint32_t));
+  }
+
+  MPI_Datatype pool_type;
+  MPI_Type_contiguous(local.size() * sizeof(uint64_t), MPI_BYTE, &pool_type);
+  MPI_Type_commit(&pool_type);
+
+  MPI_Op merge;
+  MPI_Op_create(merge_op, 0, &merge);
+
+  int world_rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  std::vector<uint64_t> global(world_rank == root ? local.size() : 0);
+  MPI_Reduce(local.data(), global.data(), 1, pool_type, merge, root, MPI_COMM_WORLD);
+
+  MPI_Op_free(&merge);
+  MPI_Type_free(&pool_type);
+
+  std::vector<Solution> result;
+  if (world_rank == root) {
+    result.resize(global[0]);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      const uint64_t *r = &global[HEADER_WORDS + i * rec];
+      double vals[3];
+      memcpy(vals, r, sizeof(vals));
+      result[i].obj = vals[0];
+      result[i].f1 = vals[1];
+      result[i].f2 = vals[2];
+      result[i].pat.resize(ps);
+      memcpy(result[i].pat.begin(), r + 3, ps * sizeof(uint32_t));
+    }
+  }
+  return result;
+}
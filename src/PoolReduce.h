@@ -0,0 +1,30 @@
+#ifndef POOL_REDUCE_H
+#define POOL_REDUCE_H
+
+#include <mpi.h>
+#include <vector>
+#include "Solution.h"
+
+//------------------------------------------------------------------------------
+// Merges the solution pools of all ranks into one top-K pool on root with
+// MPI_Reduce and a custom merge operator, so the merge runs as a tree instead
+// of K inserts per rank on root. Each pool travels as one element of a
+// derived type, which MPI never splits across calls to the operator:
+//
+//   header:  uint64   number of solutions
+//            uint64   pattern size (ps)
+//            uint64   max number of solutions (K)
+//   record:  double   obj, f1, f2
+//            uint32   bin index (x ps), padded to a multiple of 8 bytes
+//
+// Records are kept sorted by decreasing obj. Rank order is kept among
+// solutions with equal obj and duplicate patterns are dropped.
+//------------------------------------------------------------------------------
+namespace PoolReduce {
+  std::vector<Solution> reduce(const std::vector<Solution> &sols, const std::size_t ps,
+                               const std::size_t max_size, const int root);
+
+  std::size_t get_buffer_size(const std::size_t ps, const std::size_t max_size);
+}
+
+#endif
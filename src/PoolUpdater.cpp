@@ -0,0 +1,268 @@
+#include "PoolUpdater.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include "SolPool.h"
+#include "Threads.h"
+#include "Utils.h"
+
+namespace {
+  //----------------------------------------------------------------------------
+  // Returns pat without its i-th bin
+  //----------------------------------------------------------------------------
+  Pattern without(const Pattern &pat, const std::size_t i) {
+    Pattern sub;
+    for (std::size_t j = 0; j < pat.size(); ++j) {
+      if (j != i) {
+        sub.push_back(pat[j]);
+      }
+    }
+    return sub;
+  }
+}
+
+PoolUpdater::PoolUpdater(const ExprsData &_data, const std::size_t _num_threads) : data(&_data),
+                                                                                   num_threads(_num_threads > 0 ? _num_threads : 1) {}
+
+PoolUpdater::~PoolUpdater() {}
+
+//------------------------------------------------------------------------------
+// Sets c1 and c2 to the number of new individuals of each group in cover
+//------------------------------------------------------------------------------
+void PoolUpdater::count_new(const std::vector<uint64_t> &cover, uint64_t &c1, uint64_t &c2) const {
+  c1 = data->count_in_mask(cover, data->get_grp1_mask());
+  c2 = data->count_in_mask(cover, data->get_grp2_mask());
+}
+
+//------------------------------------------------------------------------------
+// Returns the count cache of the grown cohort, with the updated pools of PS1
+// to min(max_ps, levels of old). num_unknown gets, for each level, the number
+// of patterns with unknown old counts that could still make its pool.
+//------------------------------------------------------------------------------
+CountCache PoolUpdater::update(const CountCache &old, const double min_obj, const std::size_t max_size,
+                               const std::size_t max_ps, std::vector<std::size_t> &num_unknown) const {
+  if (old.risk != data->get_risk()) {
+    throw std::runtime_error("PoolUpdater: RISK differs from the run being updated");
+  }
+  if (old.case_counts.size() != data->get_num_bins()) {
+    throw std::runtime_error("PoolUpdater: NUM_EXPRS differs from the run being updated");
+  }
+
+  const bool risk = old.risk;
+  const double n1 = risk ? old.num_cases : old.num_ctrls;
+  const double n2 = risk ? old.num_ctrls : old.num_cases;
+  const double total1 = n1 + data->get_num_grp1();
+  const double total2 = n2 + data->get_num_grp2();
+  const double r1 = n1 / total1;
+  const double r2 = n2 / total2;
+
+  CountCache updated;
+  updated.count_bins(*data);
+  updated.num_cases += old.num_cases;
+  updated.num_ctrls += old.num_ctrls;
+  for (std::size_t i = 0; i < data->get_num_bins(); ++i) {
+    updated.case_counts[i] += old.case_counts[i];
+    updated.ctrl_counts[i] += old.ctrl_counts[i];
+  }
+
+  // PS1 scores every bin, so the cached bin counts make it exact
+  const std::vector<uint64_t> &counts1 = risk ? updated.case_counts : updated.ctrl_counts;
+  const std::vector<uint64_t> &counts2 = risk ? updated.ctrl_counts : updated.case_counts;
+  SolPool pool(max_size);
+  for (std::size_t i = 0; i < data->get_num_bins(); ++i) {
+    const double f1 = counts1[i] / total1;
+    const double f2 = counts2[i] / total2;
+    if (f1 >= min_obj && f1 - f2 >= min_obj) {
+      pool.add_solution(f1, f2, Pattern{i});
+    }
+  }
+
+  updated.levels.resize(1);
+  updated.levels[0].min_obj = min_obj;
+  updated.levels[0].max_size = max_size;
+  updated.levels[0].exact = true;
+  updated.levels[0].sols = pool.get_solutions();
+  num_unknown.assign(1, 0);
+
+  // Old and new counts of each bin in both groups
+  std::vector<uint64_t> old1(risk ? old.case_counts : old.ctrl_counts);
+  std::vector<uint64_t> old2(risk ? old.ctrl_counts : old.case_counts);
+  std::vector<uint64_t> new1(data->get_num_bins()), new2(data->get_num_bins());
+  for (std::size_t i = 0; i < data->get_num_bins(); ++i) {
+    new1[i] = counts1[i] - old1[i];
+    new2[i] = counts2[i] - old2[i];
+  }
+  const uint64_t num_old2 = n2, num_new2 = data->get_num_grp2();
+
+  // Largest share r1 a - r2 b of an updated obj that the old individuals can
+  // give a pattern whose old frequencies are a <= A and b >= B, with an old
+  // obj a - b of at most t
+  auto old_bound = [&](const double A, const double B, const double t) {
+    const double b = std::min(1.0, std::max(B, A - t));
+    return std::max(r1 * std::min(A, B + t) - r2 * B, r1 * std::min(A, b + t) - r2 * b);
+  };
+  auto at_least = [](const uint64_t x, const uint64_t y, const uint64_t n) { return x + y > n ? x + y - n : 0; };
+
+  // Old counts of the patterns of the last updated level
+  std::map<Pattern, std::pair<uint64_t, uint64_t>> old_counts;
+
+  const std::size_t num_levels = std::min(max_ps, old.levels.size());
+  for (std::size_t k = 2; k <= num_levels; ++k) {
+    const CountCache::Level &old_level = old.levels[k - 1];
+    const std::vector<Solution> &parents = updated.levels[k - 2].sols;
+
+    std::set<Pattern> old_pats, old_parents;
+    for (auto &s : old_level.sols) {
+      old_pats.insert(s.pat);
+    }
+    for (auto &s : old.levels[k - 2].sols) {
+      old_parents.insert(s.pat);
+    }
+    std::map<Pattern, std::size_t> parent_index;
+    std::vector<std::pair<uint64_t, uint64_t>> parent_counts(parents.size());
+    for (std::size_t p = 0; p < parents.size(); ++p) {
+      parent_index[parents[p].pat] = p;
+      parent_counts[p] = k == 2 ? std::make_pair(old1[parents[p].pat[0]], old2[parents[p].pat[0]]) :
+                                  old_counts[parents[p].pat];
+    }
+
+    // Old pooled patterns the updated search still reaches keep their cached
+    // counts plus the new ones
+    pool.clear();
+    old_counts.clear();
+    std::vector<uint64_t> cover;
+    for (auto &s : old_level.sols) {
+      bool reached = (k == 2);
+      for (std::size_t i = 0; i < s.pat.size() && !reached; ++i) {
+        reached = parent_index.count(without(s.pat, i)) > 0;
+      }
+      if (!reached) {
+        continue;
+      }
+
+      uint64_t c1, c2;
+      data->get_cover(s.pat, cover);
+      count_new(cover, c1, c2);
+      const uint64_t o1 = std::llround(s.f1 * n1);
+      const uint64_t o2 = std::llround(s.f2 * n2);
+      old_counts[s.pat] = std::make_pair(o1, o2);
+
+      // Like the search, PS2 keeps every pair with f1 >= MIN_OBJ
+      const double f1 = (o1 + c1) / total1;
+      const double f2 = (o2 + c2) / total2;
+      if (f1 >= min_obj && (k == 2 || f1 - f2 >= min_obj)) {
+        pool.add_solution(f1, f2, s.pat);
+      }
+    }
+    const bool full = pool.size() == max_size;
+    const double threshold = full ? pool.get_min_obj() : min_obj;
+
+    // Any other pattern the old search scored had an old obj of at most theta
+    const double theta = old_level.sols.size() < old_level.max_size || old_level.sols.empty() ?
+                         old_level.min_obj : std::max(old_level.min_obj, old_level.sols.back().obj);
+    const double known_theta = old_level.exact ? theta : 1.0;
+
+    // A PS2 pool that was not full held every pair with an old f1 of at least
+    // its MIN_OBJ
+    const double known_f1 = old_level.exact && old_level.sols.size() < old_level.max_size ?
+                            old_level.min_obj : 1.0;
+
+    std::atomic<std::size_t> unknown(0);
+    if (k == 2) {
+      // The old search scored every pair. Its old counts are bounded by those
+      // of its bins, and so are its new ones before they are counted. Until
+      // the pool is full any pair with f1 >= MIN_OBJ makes it, so then only
+      // f1 is bounded.
+      Threads::parallel_for(data->get_num_bins(), BATCH_SIZE, num_threads, data->get_numa_policy(),
+                            [&](std::size_t b, std::size_t e) {
+        std::vector<uint64_t> pair_cover;
+        std::size_t count = 0;
+        for (std::size_t i = b; i < e; ++i) {
+          for (std::size_t j = i + 1; j < data->get_num_bins(); ++j) {
+            const double A = std::min(old1[i], old1[j]) / n1;
+            const double bound = full ? old_bound(A, at_least(old2[i], old2[j], num_old2) / n2, known_theta) :
+                                        r1 * std::min(A, known_f1);
+            if (full ? bound + std::min(new1[i], new1[j]) / total1 -
+                       at_least(new2[i], new2[j], num_new2) / total2 <= threshold :
+                       bound + std::min(new1[i], new1[j]) / total1 < min_obj) {
+              continue;
+            }
+
+            const Pattern pat{i, j};
+            if (old_pats.count(pat) > 0) {
+              continue;
+            }
+            uint64_t c1, c2;
+            data->get_cover(pat, pair_cover);
+            count_new(pair_cover, c1, c2);
+            if (full ? bound + c1 / total1 - c2 / total2 > threshold : bound + c1 / total1 >= min_obj) {
+              ++count;
+            }
+          }
+        }
+        unknown += count;
+      });
+    } else {
+      // A child's old counts are bounded by those of its parent and new bin
+      Threads::parallel_for(parents.size(), BATCH_SIZE, num_threads, data->get_numa_policy(),
+                            [&](std::size_t b, std::size_t e) {
+        std::vector<uint64_t> parent_cover, child_cover;
+        std::size_t count = 0;
+        for (std::size_t p = b; p < e; ++p) {
+          const Pattern &parent = parents[p].pat;
+          data->get_cover(parent, parent_cover);
+
+          for (std::size_t i = 0; i < data->get_num_bins(); ++i) {
+            if (std::find(parent.begin(), parent.end(), i) != parent.end()) {
+              continue;
+            }
+
+            const double A = std::min(parent_counts[p].first, old1[i]) / n1;
+            const double B = at_least(parent_counts[p].second, old2[i], num_old2) / n2;
+            child_cover = parent_cover;
+            data->and_bin(i, child_cover.data());
+            uint64_t c1, c2;
+            count_new(child_cover, c1, c2);
+            const double gain = c1 / total1 - c2 / total2;
+            if (old_bound(A, B, 1.0) + gain <= threshold) {
+              continue;
+            }
+
+            Pattern child = parent;
+            child.push_back(i);
+            std::sort(child.begin(), child.end());
+            if (old_pats.count(child) > 0) {
+              continue;
+            }
+
+            // Count each child once, for the first parent that reaches it, and
+            // only use the old threshold if an old parent reached it too
+            bool first = true, known = false;
+            for (std::size_t s = 0; s < child.size(); ++s) {
+              const Pattern sub = without(child, s);
+              auto it = parent_index.find(sub);
+              first = first && (it == parent_index.end() || it->second >= p);
+              known = known || old_parents.count(sub) > 0;
+            }
+            if (first && old_bound(A, B, known ? known_theta : 1.0) + gain > threshold) {
+              ++count;
+            }
+          }
+        }
+        unknown += count;
+      });
+    }
+
+    updated.levels.resize(k);
+    updated.levels[k - 1].min_obj = min_obj;
+    updated.levels[k - 1].max_size = max_size;
+    updated.levels[k - 1].exact = updated.levels[k - 2].exact && unknown == 0;
+    updated.levels[k - 1].sols = pool.get_solutions();
+    num_unknown.push_back(unknown);
+  }
+
+  return updated;
+}
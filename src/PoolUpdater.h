@@ -0,0 +1,33 @@
+#ifndef POOL_UPDATER_H
+#define POOL_UPDATER_H
+
+#include <vector>
+#include "CountCache.h"
+#include "ExprsData.h"
+
+// Folds newly appended individuals into the pools of an earlier run without
+// its data. data holds only the new individuals. PS1 is redone exactly from
+// the cached bin counts. Every pooled pattern of a higher level that the
+// updated search would still reach gets its new counts added to its cached
+// ones and the pool is re-ranked. Patterns outside the cached pool have
+// unknown old counts, but a pattern the old search scored stayed below the
+// pool's threshold then, which bounds its updated obj; a level is exact only
+// if no such bound reaches the updated pool.
+class PoolUpdater {
+  private:
+    const ExprsData *data;
+    const std::size_t num_threads;
+
+    static const std::size_t BATCH_SIZE = 16;
+
+    void count_new(const std::vector<uint64_t> &cover, uint64_t &c1, uint64_t &c2) const;
+
+  public:
+    PoolUpdater(const ExprsData &_data, const std::size_t _num_threads);
+    ~PoolUpdater();
+
+    CountCache update(const CountCache &old, const double min_obj, const std::size_t max_size,
+                      const std::size_t max_ps, std::vector<std::size_t> &num_unknown) const;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "PoolWriter.h"
+#include <stdexcept>
+#include "PoolFile.h"
+
+PoolWriter::PoolWriter() : busy(false),
+                           stopping(false),
+                           thread(&PoolWriter::run, this) {}
+
+PoolWriter::~PoolWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  job_ready.notify_one();
+  thread.join();
+}
+
+//------------------------------------------------------------------------------
+// Converts the POOL_FORMAT config value
+//------------------------------------------------------------------------------
+PoolWriter::Format PoolWriter::parse_format(const std::string &str) {
+  if (str == "text") {
+    return TEXT;
+  } else if (str == "binary") {
+    return BINARY;
+  } else if (str == "both") {
+    return BOTH;
+  }
+  throw std::runtime_error("PoolWriter: Unknown pool format '" + str + "'");
+}
+
+//------------------------------------------------------------------------------
+// Background loop. Writes queued jobs until the writer is destroyed and the
+// queue is empty.
+//------------------------------------------------------------------------------
+void PoolWriter::run() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      job_ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      job = std::move(jobs.front());
+      jobs.pop_front();
+      busy = true;
+    }
+
+    job();
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      busy = false;
+    }
+    job_done.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queues a copy of the solutions to be written to file_name (text) and/or
+// file_name.bin (binary)
+//------------------------------------------------------------------------------
+void PoolWriter::write(const std::string &file_name, const std::vector<Solution> &sols,
+                       const Format format) {
+  queue([file_name, sols, format] {
+    if (format != BINARY) {
+      PoolFile::write_text(file_name, sols);
+    }
+    if (format != TEXT) {
+      PoolFile::write_binary(file_name + ".bin", sols);
+    }
+  });
+}
+
+//------------------------------------------------------------------------------
+// Queues a copy of the checkpoint to be written to file_name
+//------------------------------------------------------------------------------
+void PoolWriter::write_checkpoint(const std::string &file_name, const Checkpoint &checkpoint) {
+  queue([file_name, checkpoint] {
+    checkpoint.write(file_name);
+  });
+}
+
+//------------------------------------------------------------------------------
+// Queues a copy of the count cache to be written to file_name
+//------------------------------------------------------------------------------
+void PoolWriter::write_counts(const std::string &file_name, const CountCache &counts) {
+  queue([file_name, counts] {
+    counts.write(file_name);
+  });
+}
+
+//------------------------------------------------------------------------------
+// Adds a job to the back of the queue
+//------------------------------------------------------------------------------
+void PoolWriter::queue(const std::function<void()> &job) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    jobs.push_back(job);
+  }
+  job_ready.notify_one();
+}
+
+//------------------------------------------------------------------------------
+// Blocks until every queued job has been written
+//------------------------------------------------------------------------------
+void PoolWriter::wait() {
+  std::unique_lock<std::mutex> lock(mtx);
+  job_done.wait(lock, [this] { return jobs.empty() && !busy; });
+}
@@ -0,0 +1,46 @@
+#ifndef POOL_WRITER_H
+#define POOL_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Checkpoint.h"
+#include "CountCache.h"
+#include "Solution.h"
+
+// Writes solution pool snapshots, checkpoints and count caches on a background
+// thread so the caller can continue while the files are written. Jobs are
+// written in the order queued.
+class PoolWriter {
+  public:
+    enum Format {TEXT, BINARY, BOTH};
+
+  private:
+    std::deque<std::function<void()>> jobs;
+    std::mutex mtx;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    bool busy;
+    bool stopping;
+    std::thread thread;
+
+    void run();
+    void queue(const std::function<void()> &job);
+
+  public:
+    PoolWriter();
+    ~PoolWriter();
+
+    static Format parse_format(const std::string &str);
+
+    void write(const std::string &file_name, const std::vector<Solution> &sols, const Format format);
+    void write_checkpoint(const std::string &file_name, const Checkpoint &checkpoint);
+    void write_counts(const std::string &file_name, const CountCache &counts);
+    void wait();
+};
+
+#endif
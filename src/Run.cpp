@@ -0,0 +1,191 @@
+#include "Run.h"
+#include <algorithm>
+#include <cerrno>
+#include <functional>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace {
+  void make_dir(const std::string &dir) {
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+      throw std::runtime_error("Run: Could not create directory " + dir);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Values of a sweep key as given in the config file, paired with the parsed
+  // value and sorted with compare
+  //----------------------------------------------------------------------------
+  template<typename T, typename Parse, typename Compare>
+  std::vector<std::pair<std::string, T>> get_values(const ConfigParser &parser, const std::string &key,
+                                                    Parse parse, Compare compare) {
+    std::vector<std::pair<std::string, T>> values;
+    for (auto &item : parser.getList(key)) {
+      try {
+        values.push_back(std::make_pair(item, parse(item)));
+      } catch (std::logic_error &) {
+        throw std::runtime_error("Run: Invalid value '" + item + "' for " + key);
+      }
+    }
+    if (values.empty()) {
+      throw std::runtime_error("Run: No value given for " + key);
+    }
+
+    std::stable_sort(values.begin(), values.end(),
+                     [&](const std::pair<std::string, T> &a, const std::pair<std::string, T> &b) {
+                       return compare(a.second, b.second);
+                     });
+    return values;
+  }
+
+  // Part of the directory name for one value of a key, or nothing if the key
+  // is not swept
+  template<typename T>
+  std::string get_label(const std::string &key, const std::vector<std::pair<std::string, T>> &values,
+                        const std::size_t i) {
+    return values.size() > 1 ? key + "-" + values[i].first : "";
+  }
+
+  // Joins the non-empty parts with sep
+  std::string join(const std::vector<std::string> &parts, const std::string &sep) {
+    std::string joined;
+    for (auto &p : parts) {
+      if (!p.empty()) {
+        joined += (joined.empty() ? "" : sep) + p;
+      }
+    }
+    return joined;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns the runs of the job. RISK both gives a risk and a protective run of
+// each stratum and fold, the protective ones right after the risk ones, so
+// the first risk run can find the PS1 and PS2 pools of both (see
+// get_mirror). STRATA <column>=<value>,... gives one run per stratum in
+// <column>-<value>/ of the direction, and NUM_FOLDS k one run per fold in
+// fold-<f>/ of the stratum. MIN_OBJ, SOL_POOL_SIZE and MAX_PS may be comma
+// separated lists, which give one run per combination in the subdirectory
+// <KEY>-<value>_... of the direction, stratum or fold. Within a group, runs
+// are ordered by increasing MIN_OBJ, then decreasing SOL_POOL_SIZE, then
+// increasing MAX_PS, so the first run keeps the most PS1 and PS2 solutions
+// and a run that only differs from the one before it in MAX_PS can continue
+// from it. The directories are created by make_dirs.
+//------------------------------------------------------------------------------
+std::vector<Run> Run::list(const ConfigParser &parser) {
+  const std::string scratch_dir = parser.getString("SCRATCH_DIR");
+
+  // Each direction, stratum and fold is one group of runs with its own
+  // directory
+  std::vector<Run> groups;
+  const std::vector<std::pair<std::string, bool>> directions =
+    parser.getString("RISK") == "both" ?
+      std::vector<std::pair<std::string, bool>>{{"risk", true}, {"protective", false}} :
+      std::vector<std::pair<std::string, bool>>{{"", parser.getBool("RISK")}};
+
+  const std::size_t num_folds = parser.hasParameter("NUM_FOLDS") ? parser.getSizeT("NUM_FOLDS") : 0;
+  if (num_folds == 1) {
+    throw std::runtime_error("Run: NUM_FOLDS must be at least 2");
+  }
+  if (num_folds > std::min(parser.getSizeT("NUM_CASES"), parser.getSizeT("NUM_CTRLS"))) {
+    throw std::runtime_error("Run: NUM_FOLDS must not exceed NUM_CASES or NUM_CTRLS");
+  }
+
+  std::vector<std::string> strata{""};
+  if (parser.hasParameter("STRATA")) {
+    if (!parser.hasParameter("ANNOTATION_FILE")) {
+      throw std::runtime_error("Run: STRATA needs an ANNOTATION_FILE");
+    }
+    strata = parser.getList("STRATA");
+    for (auto &stratum : strata) {
+      const std::size_t eq = stratum.find('=');
+      if (eq == 0 || eq == std::string::npos || eq + 1 == stratum.size() ||
+          stratum.find('/') != std::string::npos) {
+        throw std::runtime_error("Run: Stratum '" + stratum + "' is not of the form <column>=<value>");
+      }
+    }
+  }
+
+  for (auto &stratum : strata) {
+    std::string stratum_name = stratum;
+    std::replace(stratum_name.begin(), stratum_name.end(), '=', '-');
+
+    for (std::size_t fold = (num_folds > 0 ? 1 : 0); fold <= num_folds; ++fold) {
+      for (auto &d : directions) {
+        Run group;
+        group.name = join({d.first, stratum_name, fold > 0 ? "fold-" + std::to_string(fold) : ""}, "/");
+        group.scratch_dir = scratch_dir + group.name + (group.name.empty() ? "" : "/");
+        group.risk = d.second;
+        group.stratum = stratum;
+        group.fold = fold;
+        group.num_folds = num_folds;
+        groups.push_back(group);
+      }
+    }
+  }
+
+  const auto min_objs = get_values<double>(parser, "MIN_OBJ",
+                                           [](const std::string &s) { return std::stod(s); },
+                                           std::less<double>());
+  const auto pool_sizes = get_values<std::size_t>(parser, "SOL_POOL_SIZE",
+                                                  [](const std::string &s) { return std::stoul(s); },
+                                                  std::greater<std::size_t>());
+  const auto max_pss = get_values<std::size_t>(parser, "MAX_PS",
+                                               [](const std::string &s) { return std::stoul(s); },
+                                               std::less<std::size_t>());
+
+  std::vector<Run> runs;
+  for (auto &group : groups) {
+    for (std::size_t i = 0; i < min_objs.size(); ++i) {
+      for (std::size_t j = 0; j < pool_sizes.size(); ++j) {
+        for (std::size_t k = 0; k < max_pss.size(); ++k) {
+          const std::string combo = join({get_label("MIN_OBJ", min_objs, i),
+                                          get_label("SOL_POOL_SIZE", pool_sizes, j),
+                                          get_label("MAX_PS", max_pss, k)}, "_");
+
+          Run run = group;
+          run.name = join({group.name, combo}, "/");
+          run.scratch_dir = group.scratch_dir + combo + (combo.empty() ? "" : "/");
+          run.min_obj = min_objs[i].second;
+          run.sol_pool_size = pool_sizes[j].second;
+          run.max_ps = max_pss[k].second;
+          runs.push_back(run);
+        }
+      }
+    }
+  }
+  return runs;
+}
+
+//------------------------------------------------------------------------------
+// Creates SCRATCH_DIR and every directory on the way to each run's scratch
+// directory. Called by rank 0 only, so ranks do not race to create them on a
+// shared filesystem.
+//------------------------------------------------------------------------------
+void Run::make_dirs(const ConfigParser &parser, const std::vector<Run> &runs) {
+  const std::string scratch_dir = parser.getString("SCRATCH_DIR");
+  make_dir(scratch_dir);
+  for (auto &run : runs) {
+    for (std::size_t pos = scratch_dir.size(); pos < run.scratch_dir.size(); ++pos) {
+      if (run.scratch_dir[pos] == '/') {
+        make_dir(run.scratch_dir.substr(0, pos));
+      }
+    }
+    make_dir(run.scratch_dir);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns the first run after runs[index] in the other direction on the same
+// stratum and fold, or runs.size() if there is none. Its group 1 is the group
+// 2 of runs[index], so the PS1 and PS2 counts of one give the pools of both.
+//------------------------------------------------------------------------------
+std::size_t Run::get_mirror(const std::vector<Run> &runs, const std::size_t index) {
+  for (std::size_t i = index + 1; i < runs.size(); ++i) {
+    if (runs[i].risk != runs[index].risk && runs[i].stratum == runs[index].stratum &&
+        runs[i].fold == runs[index].fold) {
+      return i;
+    }
+  }
+  return runs.size();
+}
@@ -0,0 +1,31 @@
+#ifndef RUN_H
+#define RUN_H
+
+#include <string>
+#include <vector>
+#include "ConfigParser.h"
+
+// One search over the loaded data. A job runs every Run given by list() in
+// turn, on the same ExprsData. A job with a single run writes straight to
+// SCRATCH_DIR; otherwise each run writes to SCRATCH_DIR/<name>/. stratum is
+// empty for a run on the whole cohort, or the <column>=<value> condition on
+// the annotation file selecting its individuals. fold is 0 for a run on the
+// whole stratum, or the held-out fold (1 to num_folds) of a cross-validation
+// run.
+struct Run {
+  std::string name;
+  std::string scratch_dir;
+  bool risk;
+  std::string stratum;
+  double min_obj;
+  std::size_t sol_pool_size;
+  std::size_t max_ps;
+  std::size_t fold;
+  std::size_t num_folds;
+
+  static std::vector<Run> list(const ConfigParser &parser);
+  static void make_dirs(const ConfigParser &parser, const std::vector<Run> &runs);
+  static std::size_t get_mirror(const std::vector<Run> &runs, const std::size_t index);
+};
+
+#endif
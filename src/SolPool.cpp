@@ -1,8 +1,8 @@
 #include "SolPool.h"
-#include <sstream>
-#include <fstream>
 #include <algorithm>
 #include <iterator>
+#include "PatternScorer.h"
+#include "PoolFile.h"
 #include "Utils.h"
 
 SolPool::SolPool(const std::size_t _max_size) : max_size(_max_size) {}
@@ -10,7 +10,7 @@ SolPool::SolPool(const std::size_t _max_size) : max_size(_max_size) {}
 SolPool::~SolPool() {}
 
 void SolPool::sort_pool() {
-  pool.sort(utils::SortPairByFirstItemDecreasing());
+  pool.sort(utils::SortByObjDecreasing());
 }
 
 void SolPool::trim_to_max_size() {
@@ -19,34 +19,39 @@ void SolPool::trim_to_max_size() {
   }
 }
 
-void SolPool::add_solution(const std::pair<double, std::vector<std::size_t>> &obj_sol_pair) {
-  std::pair<double, std::vector<std::size_t>> new_pair = obj_sol_pair;
-  std::sort(new_pair.second.begin(), new_pair.second.end());
+//------------------------------------------------------------------------------
+// Adds the solution if it is not already in the pool and the pool is not full
+// of better solutions. Returns true if the solution was added.
+//------------------------------------------------------------------------------
+bool SolPool::add_solution(const Solution &new_sol) {
+  Solution sorted_sol = new_sol;
+  std::sort(sorted_sol.pat.begin(), sorted_sol.pat.end());
 
   if (pool.empty()) {
-    pool.push_front(new_pair);
-    return;
+    pool.push_front(sorted_sol);
+    return true;
   }
 
-  // Check if the new obj-sol pair has a smaller obj than the last element in the list
-  if (new_pair.first < pool.back().first) {
+  // Check if the new solution has a smaller obj than the last element in the list
+  if (sorted_sol.obj < pool.back().obj) {
     if (pool.size() < max_size) { // Make sure pool is less than max size
-      pool.push_back(new_pair); // Add element after last element
+      pool.push_back(sorted_sol); // Add element after last element
+      return true;
     }
-    return;
+    return false;
   }
 
   // Starting at the beginning, check if any solution with samle obj value has matching
   // markers
   for (auto itr = pool.begin(); itr != pool.end(); itr++) {
-    if ((new_pair.second == (*itr).second)) { // (new_pair.first == (*itr).first) && 
-      return;
+    if ((sorted_sol.pat == (*itr).pat)) {
+      return false;
     }
   }
   
   for (auto itr = pool.begin(); itr != pool.end(); itr++) {
-    if (new_pair.first >= (*itr).first) {
-      pool.insert(itr, new_pair); // Insert
+    if (sorted_sol.obj >= (*itr).obj) {
+      pool.insert(itr, sorted_sol); // Insert
       break;
     }
   }  
@@ -55,82 +60,61 @@ void SolPool::add_solution(const std::pair<double, std::vector<std::size_t>> &ob
   if (pool.size() > max_size) {
     pool.pop_back();
   }
+  return true;
 }
 
-void SolPool::add_solution(const double obj, const std::vector<std::size_t> &sol) {
-  const std::pair<double, std::vector<std::size_t>> new_sol = std::make_pair(obj, sol);
-
-  add_solution(new_sol);
+bool SolPool::add_solution(const double f1, const double f2, const Pattern &sol) {
+  return add_solution(Solution(f1, f2, sol));
 }
 
-void SolPool::read_from_file(const std::string &file_name, const ExprsData &data) {
-  std::string tmpStr, s;
-	std::istringstream iss;
-	std::ifstream input;
-
-  // Open the file
-  input.open(file_name.c_str());
-
-  // Check if file opened
-  if (!input) {
-    fprintf(stderr, "ERROR - SolPool::read_from_file - Could not open file (%s)\n", file_name.c_str());		
-    exit(1);
-  }
-
-  // Loop through file, reading each line
-  while (std::getline(input, tmpStr)) {
-    // Count number of spaces
-    std::size_t ps = std::count(tmpStr.begin(), tmpStr.end(), ' ') + 1;
-    std::vector<std::size_t> pat;
-    pat.reserve(ps);
+//------------------------------------------------------------------------------
+// Replaces the pool with the solutions, keeping the given order among solutions
+// with equal obj
+//------------------------------------------------------------------------------
+void SolPool::set_solutions(const std::vector<Solution> &sols) {
+  pool.assign(sols.begin(), sols.end());
 
-    // Clear and update istringstream
-    iss.clear();
-    iss.str(tmpStr);
-
-    while (std::getline(iss, s, ' ')) {
-      pat.push_back(std::stoul(s));
-    }
+  sort_pool();
+  trim_to_max_size();
+}
 
-    double obj = data.get_grp1_freq(pat) - data.get_grp2_freq(pat);
+//------------------------------------------------------------------------------
+// Reads a text pool file and scores its patterns in parallel batches
+//------------------------------------------------------------------------------
+void SolPool::read_from_file(const std::string &file_name, const ExprsData &data, const std::size_t num_threads) {
+  PatternScorer scorer(data, num_threads);
 
-    pool.push_back(std::make_pair(obj, pat));
+  for (auto &s : scorer.score(scorer.read_patterns(file_name))) {
+    pool.push_back(s);
   }
 
   sort_pool();
   trim_to_max_size();
 }
 
-void SolPool::write_to_file(const std::string &file_name, const ExprsData &data) {
-  FILE *output;
-  if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
-    fprintf(stderr, "ERROR - SolPool::write_to_file - Could not open file %s\n", file_name.c_str());
-    exit(1);
-  }
-
-  for (auto pat : pool) {
-    for (std::size_t i = 0; i < pat.second.size()-1; ++i) {
-      fprintf(output, "%lu ", pat.second[i]);
-    }
-    fprintf(output, "%lu\n", pat.second[pat.second.size()-1]);
-    // fprintf(output, "%s\n", data.get_pat_as_str(pat.second).c_str());
-  }
-  fclose(output);
+void SolPool::read_from_binary_file(const std::string &file_name) {
+  set_solutions(PoolFile::read_binary(file_name));
 }
 
 void SolPool::clear() {
-  for (auto s : pool) {
-    s.second.clear();
-  }
   pool.clear();
 }
 
+//------------------------------------------------------------------------------
+// Changes the number of solutions kept, dropping the worst ones if the pool is
+// now over size
+//------------------------------------------------------------------------------
+void SolPool::set_max_size(const std::size_t _max_size) {
+  max_size = _max_size;
+  trim_to_max_size();
+}
+
 double SolPool::get_max_obj() const {
-  return pool.front().first;
+  return pool.front().obj;
 }
 
 double SolPool::get_min_obj() const {
-  return pool.back().first;
+  return pool.back().obj;
 }
 
 std::size_t SolPool::size() const {
@@ -141,7 +125,7 @@ std::size_t SolPool::get_max_size() const {
   return max_size;
 }
 
-std::pair<double, std::vector<std::size_t>> SolPool::get_obj_sol_pair(const std::size_t idx) const {
+std::pair<double, Pattern> SolPool::get_obj_sol_pair(const std::size_t idx) const {
   if (idx >= pool.size()) {
     fprintf(stderr, "ERROR - SolPool::get_obj_sol_pair - Trying to access obj_sol_pair at index %lu.", idx);
     fprintf(stderr, " Solution pool only has %lu elements.\n", pool.size());
@@ -150,10 +134,10 @@ std::pair<double, std::vector<std::size_t>> SolPool::get_obj_sol_pair(const std:
 
   auto itr = pool.begin();
   std::advance(itr, idx);
-  return *itr;
+  return std::make_pair((*itr).obj, (*itr).pat);
 }
 
-std::vector<std::size_t> SolPool::get_sol(const std::size_t idx) const {
+Pattern SolPool::get_sol(const std::size_t idx) const {
   if (idx >= pool.size()) {
     fprintf(stderr, "ERROR - SolPool::get_sol - Trying to access sol at index %lu.", idx);
     fprintf(stderr, " Solution pool only has %lu elements.\n", pool.size());
@@ -162,5 +146,9 @@ std::vector<std::size_t> SolPool::get_sol(const std::size_t idx) const {
 
   auto itr = pool.begin();
   std::advance(itr, idx);
-  return (*itr).second;
+  return (*itr).pat;
+}
+
+std::vector<Solution> SolPool::get_solutions() const {
+  return std::vector<Solution>(pool.begin(), pool.end());
 }
\ No newline at end of file
@@ -5,11 +5,12 @@
 #include <vector>
 #include <string>
 #include "ExprsData.h"
+#include "Solution.h"
 
 class SolPool {
   private:
-    const std::size_t max_size;
-    std::list<std::pair<double, std::vector<std::size_t>>> pool;
+    std::size_t max_size;
+    std::list<Solution> pool;
 
     void sort_pool();
     void trim_to_max_size();
@@ -18,20 +19,23 @@ class SolPool {
     SolPool(const std::size_t _max_size);
     ~SolPool();
 
-    void add_solution(const std::pair<double, std::vector<std::size_t>> &obj_sol_pair);
-    void add_solution(const double obj, const std::vector<std::size_t> &sol);
+    bool add_solution(const Solution &new_sol);
+    bool add_solution(const double f1, const double f2, const Pattern &sol);
+    void set_solutions(const std::vector<Solution> &sols);
 
-    void read_from_file(const std::string &file_name, const ExprsData &data);
-    void write_to_file(const std::string &file_name, const ExprsData &data);
+    void read_from_file(const std::string &file_name, const ExprsData &data, const std::size_t num_threads = 1);
+    void read_from_binary_file(const std::string &file_name);
 
     void clear();
+    void set_max_size(const std::size_t _max_size);
 
     double get_max_obj() const;
     double get_min_obj() const;
     std::size_t size() const;
     std::size_t get_max_size() const;
-    std::pair<double, std::vector<std::size_t>> get_obj_sol_pair(const std::size_t idx) const;
-    std::vector<std::size_t> get_sol(const std::size_t idx) const;
+    std::pair<double, Pattern> get_obj_sol_pair(const std::size_t idx) const;
+    Pattern get_sol(const std::size_t idx) const;
+    std::vector<Solution> get_solutions() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,21 @@
+#ifndef SOLUTION_H
+#define SOLUTION_H
+
+#include <cstddef>
+#include "Pattern.h"
+
+// A pattern together with its group frequencies. obj is f1 - f2.
+struct Solution {
+  double obj;
+  double f1;
+  double f2;
+  Pattern pat;
+
+  Solution() : obj(0.0), f1(0.0), f2(0.0) {}
+  Solution(const double _f1, const double _f2, const Pattern &_pat) : obj(_f1 - _f2),
+                                                                      f1(_f1),
+                                                                      f2(_f2),
+                                                                      pat(_pat) {}
+};
+
+#endif
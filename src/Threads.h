@@ -0,0 +1,82 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include "Numa.h"
+
+namespace Threads {
+  //----------------------------------------------------------------------------
+  // Calls func(begin, end) over [0, n) in batches of batch_size. Batches are
+  // handed out dynamically to num_threads threads; the calling thread is one
+  // of them.
+  //----------------------------------------------------------------------------
+  template<typename F>
+  void parallel_for(const std::size_t n, const std::size_t batch_size, const std::size_t num_threads, F func) {
+    std::atomic<std::size_t> next(0);
+
+    auto run = [&]() {
+      std::size_t begin;
+      while ((begin = next.fetch_add(batch_size)) < n) {
+        func(begin, std::min(n, begin + batch_size));
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < num_threads; ++t) {
+      threads.push_back(std::thread(run));
+    }
+    run();
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // As above, but unless policy is NONE thread t is pinned to NUMA node
+  // t % nodes and [0, n) is split into one contiguous range per node. Threads
+  // take batches from their own node's range first and only then help the
+  // other nodes, so most batches run next to the memory they were placed on.
+  //----------------------------------------------------------------------------
+  template<typename F>
+  void parallel_for(const std::size_t n, const std::size_t batch_size, const std::size_t num_threads,
+                    const Numa::Policy policy, F func) {
+    const std::size_t num_nodes = std::min(num_threads, Numa::get_nodes().size());
+    if (policy == Numa::NONE || num_nodes <= 1) {
+      parallel_for(n, batch_size, num_threads, func);
+      return;
+    }
+
+    std::vector<std::atomic<std::size_t>> next(num_nodes);
+    std::vector<std::size_t> stop(num_nodes);
+    for (std::size_t k = 0; k < num_nodes; ++k) {
+      next[k] = k * n / num_nodes;
+      stop[k] = (k + 1) * n / num_nodes;
+    }
+
+    auto run = [&](const std::size_t node) {
+      Numa::Pin pin(node);
+      for (std::size_t d = 0; d < num_nodes; ++d) {
+        const std::size_t k = (node + d) % num_nodes;
+        std::size_t begin;
+        while ((begin = next[k].fetch_add(batch_size)) < stop[k]) {
+          func(begin, std::min(stop[k], begin + batch_size));
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < num_threads; ++t) {
+      threads.push_back(std::thread(run, t % num_nodes));
+    }
+    run(0);
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+}
+
+#endif
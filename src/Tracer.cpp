@@ -0,0 +1,106 @@
+#include "Tracer.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+  const char *SPAN_NAMES[Tracer::NUM_SPANS] = {"level", "dispatch", "wait", "receive", "merge", "compute",
+                                               "send_back"};
+  const int DOUBLES_PER_EVENT = 4;
+}
+
+Tracer::Tracer(const ConfigParser &parser) : enabled(parser.hasParameter("TRACE_FILE")),
+                                             file_name(enabled ? parser.getString("TRACE_FILE") : ""),
+                                             origin(0.0) {
+  if (enabled) {
+    events.reserve(1 << 16);
+    MPI_Barrier(MPI_COMM_WORLD);
+    origin = MPI_Wtime();
+  }
+}
+
+Tracer::~Tracer() {}
+
+bool Tracer::is_enabled() const {
+  return enabled;
+}
+
+//------------------------------------------------------------------------------
+// Seconds since the aligned origin
+//------------------------------------------------------------------------------
+double Tracer::now() const {
+  return enabled ? MPI_Wtime() - origin : 0.0;
+}
+
+//------------------------------------------------------------------------------
+// Records a span that started at start (from now()) and ends now
+//------------------------------------------------------------------------------
+void Tracer::record(const Span span, const double start, const double arg) {
+  if (enabled) {
+    events.push_back(Event{start, now() - start, arg, span});
+  }
+}
+
+//------------------------------------------------------------------------------
+// Collective over MPI_COMM_WORLD. Gathers every rank's spans on root, which
+// writes them to TRACE_FILE.
+//------------------------------------------------------------------------------
+void Tracer::write(const int root) {
+  if (!enabled) {
+    return;
+  }
+
+  int world_rank, world_size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+  std::vector<double> local;
+  local.reserve(DOUBLES_PER_EVENT * events.size());
+  for (auto &e : events) {
+    local.push_back(e.start);
+    local.push_back(e.dur);
+    local.push_back(e.arg);
+    local.push_back(e.span);
+  }
+
+  int num_local = local.size();
+  std::vector<int> counts(world_size), displs(world_size);
+  MPI_Gather(&num_local, 1, MPI_INT, counts.data(), 1, MPI_INT, root, MPI_COMM_WORLD);
+
+  std::size_t total = 0;
+  for (int p = 0; p < world_size; ++p) {
+    displs[p] = total;
+    total += counts[p];
+  }
+
+  std::vector<double> all(world_rank == root ? total : 0);
+  MPI_Gatherv(local.data(), num_local, MPI_DOUBLE, all.data(), counts.data(), displs.data(), MPI_DOUBLE,
+              root, MPI_COMM_WORLD);
+  events.clear();
+
+  if (world_rank != root) {
+    return;
+  }
+
+  FILE *output;
+  if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Tracer::write - Could not open file %s\n", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(output, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  for (int p = 0; p < world_size; ++p) {
+    fprintf(output, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, "
+                    "\"args\": {\"name\": \"%s %d\"}}", p > 0 ? ",\n" : "", p,
+            p == root ? "controller" : "worker", p);
+  }
+  for (int p = 0; p < world_size; ++p) {
+    for (int i = displs[p]; i < displs[p] + counts[p]; i += DOUBLES_PER_EVENT) {
+      fprintf(output, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %.3f, "
+                      "\"dur\": %.3f, \"args\": {\"arg\": %.0f}}", SPAN_NAMES[static_cast<int>(all[i+3])], p,
+              1e6 * all[i], 1e6 * all[i+1], all[i+2]);
+    }
+  }
+  fprintf(output, "\n]}\n");
+
+  fclose(output);
+}
@@ -0,0 +1,40 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+#include "ConfigParser.h"
+
+// Records timestamped spans on each rank when TRACE_FILE is set. The spans of
+// all ranks are merged on rank 0 into a Chrome/Perfetto trace (JSON) by
+// write(). Time 0 is aligned across ranks with a barrier at construction.
+class Tracer {
+  public:
+    enum Span {LEVEL, DISPATCH, WAIT, RECEIVE, MERGE, COMPUTE, SEND_BACK, NUM_SPANS};
+
+  private:
+    struct Event {
+      double start;
+      double dur;
+      double arg;
+      int span;
+    };
+
+    const bool enabled;
+    const std::string file_name;
+    double origin;
+    std::vector<Event> events;
+
+  public:
+    Tracer(const ConfigParser &parser);
+    ~Tracer();
+
+    bool is_enabled() const;
+    double now() const;
+    void record(const Span span, const double start, const double arg = 0.0);
+
+    void write(const int root);
+};
+
+#endif
@@ -1,9 +1,15 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstddef>
+#include <stdint.h>
 #include <utility>
 
 namespace utils {
+  inline std::size_t popcount(const uint64_t word) {
+    return __builtin_popcountll(word);
+  }
+
   struct SortPairByFirstItemDecreasing {
     template<typename T, typename U>
     bool operator()(const std::pair<T, U> &lhs, const std::pair<T, U> &rhs) const {
@@ -25,6 +31,13 @@ namespace utils {
     }
   };
 
+  struct SortByObjDecreasing {
+    template<typename T>
+    bool operator()(const T &lhs, const T &rhs) const {
+      return lhs.obj > rhs.obj;
+    }
+  };
+
   struct SortPairBySecondItemIncreasing {
     template<typename T, typename U>
     bool operator()(const std::pair<T, U> &lhs, const std::pair<T, U> &rhs) const {
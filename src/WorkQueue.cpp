@@ -0,0 +1,143 @@
+#include "WorkQueue.h"
+#include "Parallel.h"
+
+//------------------------------------------------------------------------------
+// Worker w of W = world_size-1 starts with [num_tasks*(w-1)/W, num_tasks*w/W)
+//------------------------------------------------------------------------------
+WorkQueue::WorkQueue(const std::size_t num_tasks) : world_rank(Parallel::get_world_rank()),
+                                                    world_size(Parallel::get_world_size()),
+                                                    rng(world_rank),
+                                                    num_steals(0) {
+  const std::size_t num_workers = world_size - 1;
+  range[0] = num_tasks * (world_rank - 1) / num_workers;
+  range[1] = num_tasks * world_rank / num_workers;
+}
+
+WorkQueue::~WorkQueue() {}
+
+//------------------------------------------------------------------------------
+// Receives a steal request from thief and sends back the back half of this
+// rank's range, or an empty range if fewer than two tasks are left
+//------------------------------------------------------------------------------
+void WorkQueue::answer_request(const int thief) {
+  char signal;
+  MPI_Recv(&signal, 1, MPI_CHAR, thief, Parallel::STEAL_REQUEST_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+  std::size_t stolen[2] = {range[1], range[1]};
+  if (range[1] - range[0] >= 2) {
+    stolen[0] = range[1] - (range[1] - range[0]) / 2;
+    range[1] = stolen[0];
+  }
+  MPI_Send(stolen, 2, CUSTOM_SIZE_T, thief, Parallel::STEAL_REPLY_TAG, MPI_COMM_WORLD);
+}
+
+//------------------------------------------------------------------------------
+// Answers every steal request that has already arrived
+//------------------------------------------------------------------------------
+void WorkQueue::answer_requests() {
+  int flag;
+  MPI_Status status;
+  MPI_Iprobe(MPI_ANY_SOURCE, Parallel::STEAL_REQUEST_TAG, MPI_COMM_WORLD, &flag, &status);
+  while (flag) {
+    answer_request(status.MPI_SOURCE);
+    MPI_Iprobe(MPI_ANY_SOURCE, Parallel::STEAL_REQUEST_TAG, MPI_COMM_WORLD, &flag, &status);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Asks victim for work and keeps answering other thieves until it replies.
+// Returns true if a non-empty range was received.
+//------------------------------------------------------------------------------
+bool WorkQueue::steal_from(const int victim) {
+  char signal = 0;
+  MPI_Send(&signal, 1, MPI_CHAR, victim, Parallel::STEAL_REQUEST_TAG, MPI_COMM_WORLD);
+
+  MPI_Status status;
+  while (true) {
+    MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+    if (status.MPI_TAG == Parallel::STEAL_REQUEST_TAG) {
+      answer_request(status.MPI_SOURCE);
+    } else if (status.MPI_TAG == Parallel::STEAL_REPLY_TAG && status.MPI_SOURCE == victim) {
+      break;
+    }
+  }
+
+  MPI_Recv(range, 2, CUSTOM_SIZE_T, victim, Parallel::STEAL_REPLY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  return range[0] < range[1];
+}
+
+//------------------------------------------------------------------------------
+// Visits the other workers from a random starting point until one of them
+// has work to spare. Returns false if none had.
+//------------------------------------------------------------------------------
+bool WorkQueue::steal() {
+  const int num_workers = world_size - 1;
+  const int first = std::uniform_int_distribution<int>(0, num_workers - 1)(rng);
+
+  for (int k = 0; k < num_workers; ++k) {
+    const int victim = 1 + (first + k) % num_workers;
+    if (victim != world_rank && steal_from(victim)) {
+      ++num_steals;
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Tells rank 0 this worker is done and answers requests with empty ranges
+// until rank 0 releases all workers
+//------------------------------------------------------------------------------
+void WorkQueue::wait_for_release() {
+  char signal = 0;
+  MPI_Send(&signal, 1, MPI_CHAR, 0, Parallel::DISTRIBUTED_TAG, MPI_COMM_WORLD);
+
+  MPI_Status status;
+  while (true) {
+    MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+    if (status.MPI_TAG == Parallel::STEAL_REQUEST_TAG) {
+      answer_request(status.MPI_SOURCE);
+    } else if (status.MPI_TAG == Parallel::DISTRIBUTED_TAG && status.MPI_SOURCE == 0) {
+      break;
+    }
+  }
+  MPI_Recv(&signal, 1, MPI_CHAR, 0, Parallel::DISTRIBUTED_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+
+//------------------------------------------------------------------------------
+// Sets task to the next task for this rank. Returns false once there is no
+// work left on any worker.
+//------------------------------------------------------------------------------
+bool WorkQueue::next(std::size_t &task) {
+  answer_requests();
+
+  if (range[0] < range[1] || steal()) {
+    task = range[0]++;
+    return true;
+  }
+
+  wait_for_release();
+  return false;
+}
+
+std::size_t WorkQueue::get_num_steals() const {
+  return num_steals;
+}
+
+//------------------------------------------------------------------------------
+// Called on rank 0. Waits until every worker has run out of work and then
+// releases them.
+//------------------------------------------------------------------------------
+void WorkQueue::release_workers() {
+  const int world_size = Parallel::get_world_size();
+  char signal;
+
+  for (int i = 1; i < world_size; ++i) {
+    MPI_Recv(&signal, 1, MPI_CHAR, MPI_ANY_SOURCE, Parallel::DISTRIBUTED_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  }
+
+  signal = 0;
+  for (int i = 1; i < world_size; ++i) {
+    MPI_Send(&signal, 1, MPI_CHAR, i, Parallel::DISTRIBUTED_TAG, MPI_COMM_WORLD);
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <mpi.h>
+#include <random>
+
+// Task indices [0, num_tasks) split into one contiguous range per worker rank
+// (1 to world_size-1). A worker takes tasks from the front of its own range
+// and, once it is empty, asks other workers for the back half of theirs.
+// Requests are answered between tasks with point-to-point messages. A worker
+// that finds nothing left to steal tells rank 0, which releases every worker
+// once all of them are done so no request is left unanswered.
+class WorkQueue {
+  private:
+    const int world_rank;
+    const int world_size;
+    std::size_t range[2];
+    std::mt19937 rng;
+    std::size_t num_steals;
+
+    void answer_request(const int thief);
+    void answer_requests();
+    bool steal_from(const int victim);
+    bool steal();
+    void wait_for_release();
+
+  public:
+    WorkQueue(const std::size_t num_tasks);
+    ~WorkQueue();
+
+    bool next(std::size_t &task);
+    std::size_t get_num_steals() const;
+
+    static void release_workers();
+};
+
+#endif
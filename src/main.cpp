@@ -1,24 +1,462 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include "BootstrapScorer.h"
 #include "ConfigParser.h"
+#include "Estimator.h"
 #include "Parallel.h"
 #include "GreedyController.h"
 #include "GreedyWorker.h"
+#include "PatternScorer.h"
+#include "PermutationTester.h"
+#include "PoolUpdater.h"
 #include "Timer.h"
 
+//------------------------------------------------------------------------------
+// Scores the patterns in in_file and writes obj, f1 and f2 for each of them to
+// out_file. Every rank scores a contiguous share of the patterns.
+//------------------------------------------------------------------------------
+void score_patterns(const ConfigParser &parser, const std::string &in_file, const std::string &out_file) {
+  const int world_rank = Parallel::get_world_rank();
+  const int world_size = Parallel::get_world_size();
+
+  ExprsData data(parser);
+  PatternScorer scorer(data, parser.hasParameter("NUM_THREADS") ? parser.getSizeT("NUM_THREADS") : 1);
+
+  const std::vector<Pattern> pats = scorer.read_patterns(in_file);
+  const std::size_t begin = pats.size() * world_rank / world_size;
+  const std::size_t end = pats.size() * (world_rank + 1) / world_size;
+
+  std::vector<double> freqs;
+  for (auto &s : scorer.score(pats, begin, end)) {
+    freqs.push_back(s.f1);
+    freqs.push_back(s.f2);
+  }
+
+  std::vector<int> counts(world_size), displs(world_size);
+  for (int p = 0; p < world_size; ++p) {
+    displs[p] = 2 * (pats.size() * p / world_size);
+    counts[p] = 2 * (pats.size() * (p + 1) / world_size) - displs[p];
+  }
+
+  std::vector<double> all_freqs(world_rank == 0 ? 2 * pats.size() : 0);
+  MPI_Gatherv(freqs.data(), freqs.size(), MPI_DOUBLE, all_freqs.data(), counts.data(), displs.data(),
+              MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  if (world_rank == 0) {
+    FILE *output;
+    if ((output = fopen(out_file.c_str(), "w")) == nullptr) {
+      fprintf(stderr, "ERROR - Could not open file %s\n", out_file.c_str());
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    fprintf(output, "obj\tf1\tf2\tpattern\n");
+    for (std::size_t i = 0; i < pats.size(); ++i) {
+      fprintf(output, "%lf\t%lf\t%lf\t", all_freqs[2*i] - all_freqs[2*i+1], all_freqs[2*i], all_freqs[2*i+1]);
+      for (std::size_t j = 0; j < pats[i].size(); ++j) {
+        fprintf(output, j + 1 < pats[i].size() ? "%u " : "%u", pats[i][j]);
+      }
+      fprintf(output, "\n");
+    }
+    fclose(output);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes obj, f1, f2, the empirical p-value and the family-wise (max obj over
+// the file) p-value of each pattern in in_file to out_file, from
+// NUM_PERMUTATIONS relabelings of the individuals spread over the ranks, and
+// the family-wise obj thresholds to out_file.thresholds
+//------------------------------------------------------------------------------
+void permutation_test(const ConfigParser &parser, const std::string &in_file, const std::string &out_file) {
+  const int world_rank = Parallel::get_world_rank();
+  const int world_size = Parallel::get_world_size();
+
+  ExprsData data(parser);
+  const std::size_t num_threads = parser.hasParameter("NUM_THREADS") ? parser.getSizeT("NUM_THREADS") : 1;
+  PatternScorer scorer(data, num_threads);
+  const std::vector<Solution> observed = scorer.score(scorer.read_patterns(in_file));
+
+  const std::size_t num_perms = parser.hasParameter("NUM_PERMUTATIONS") ? parser.getSizeT("NUM_PERMUTATIONS") : 1000;
+  const uint64_t seed = parser.hasParameter("PERMUTATION_SEED") ? parser.getSizeT("PERMUTATION_SEED") : 1;
+  const std::size_t first = num_perms * world_rank / world_size;
+  const std::size_t last = num_perms * (world_rank + 1) / world_size;
+
+  PermutationTester tester(data, num_threads, seed);
+  std::vector<uint64_t> num_exceeding;
+  std::vector<double> max_obj;
+  tester.run(observed, first, last, num_exceeding, max_obj);
+
+  std::vector<uint64_t> all_exceeding(world_rank == 0 ? observed.size() : 0);
+  MPI_Reduce(num_exceeding.data(), all_exceeding.data(), observed.size(), MPI_UINT64_T, MPI_SUM, 0,
+             MPI_COMM_WORLD);
+
+  std::vector<int> counts(world_size), displs(world_size);
+  for (int p = 0; p < world_size; ++p) {
+    displs[p] = num_perms * p / world_size;
+    counts[p] = num_perms * (p + 1) / world_size - displs[p];
+  }
+
+  std::vector<double> all_max(world_rank == 0 ? num_perms : 0);
+  MPI_Gatherv(max_obj.data(), max_obj.size(), MPI_DOUBLE, all_max.data(), counts.data(), displs.data(),
+              MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  if (world_rank == 0) {
+    std::sort(all_max.begin(), all_max.end(), std::greater<double>());
+
+    FILE *output;
+    if ((output = fopen(out_file.c_str(), "w")) == nullptr) {
+      fprintf(stderr, "ERROR - Could not open file %s\n", out_file.c_str());
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    fprintf(output, "obj\tf1\tf2\tp_value\tfwer_p_value\tpattern\n");
+    for (std::size_t i = 0; i < observed.size(); ++i) {
+      const Solution &s = observed[i];
+      const std::size_t num_max_exceeding = std::upper_bound(all_max.begin(), all_max.end(), s.obj,
+                                                             std::greater<double>()) - all_max.begin();
+      fprintf(output, "%lf\t%lf\t%lf\t%lf\t%lf\t", s.obj, s.f1, s.f2,
+              (1.0 + all_exceeding[i]) / (1.0 + num_perms), (1.0 + num_max_exceeding) / (1.0 + num_perms));
+      for (std::size_t j = 0; j < s.pat.size(); ++j) {
+        fprintf(output, j + 1 < s.pat.size() ? "%u " : "%u", s.pat[j]);
+      }
+      fprintf(output, "\n");
+    }
+    fclose(output);
+
+    // A pattern whose obj is above the threshold for alpha has a family-wise
+    // p-value of at most alpha
+    const std::string thresholds_file = out_file + ".thresholds";
+    if ((output = fopen(thresholds_file.c_str(), "w")) == nullptr) {
+      fprintf(stderr, "ERROR - Could not open file %s\n", thresholds_file.c_str());
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    fprintf(output, "alpha\tobj_threshold\n");
+    for (double alpha : {0.1, 0.05, 0.01}) {
+      const std::size_t k = static_cast<std::size_t>(alpha * (1.0 + num_perms)) - 1;
+      if (num_perms > 0 && k < num_perms) {
+        fprintf(output, "%g\t%lf\n", alpha, all_max[k]);
+        fprintf(stderr, "FWER %g: obj > %lf\n", alpha, all_max[k]);
+      }
+    }
+    fclose(output);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes obj and its bootstrap mean, standard deviation and 95% percentile
+// interval for each pattern in in_file to out_file, from NUM_BOOTSTRAPS
+// replicates of the individuals spread over the ranks
+//------------------------------------------------------------------------------
+void bootstrap_patterns(const ConfigParser &parser, const std::string &in_file, const std::string &out_file) {
+  const int world_rank = Parallel::get_world_rank();
+  const int world_size = Parallel::get_world_size();
+
+  ExprsData data(parser);
+  const std::size_t num_threads = parser.hasParameter("NUM_THREADS") ? parser.getSizeT("NUM_THREADS") : 1;
+  PatternScorer scorer(data, num_threads);
+  const std::vector<Pattern> pats = scorer.read_patterns(in_file);
+
+  const std::size_t num_reps = parser.hasParameter("NUM_BOOTSTRAPS") ? parser.getSizeT("NUM_BOOTSTRAPS") : 1000;
+  if (num_reps == 0) {
+    throw std::runtime_error("--bootstrap needs NUM_BOOTSTRAPS of at least 1");
+  }
+  const uint64_t seed = parser.hasParameter("BOOTSTRAP_SEED") ? parser.getSizeT("BOOTSTRAP_SEED") : 1;
+  const std::size_t first = num_reps * world_rank / world_size;
+  const std::size_t last = num_reps * (world_rank + 1) / world_size;
+
+  BootstrapScorer bootstrap(data, num_threads, seed);
+  std::vector<double> objs;
+  bootstrap.score(pats, first, last, objs);
+
+  // Each rank sends a block of patterns x its replicates
+  std::vector<int> counts(world_size), displs(world_size);
+  for (int p = 0; p < world_size; ++p) {
+    displs[p] = pats.size() * (num_reps * p / world_size);
+    counts[p] = pats.size() * (num_reps * (p + 1) / world_size) - displs[p];
+  }
+
+  std::vector<double> all_objs(world_rank == 0 ? pats.size() * num_reps : 0);
+  MPI_Gatherv(objs.data(), objs.size(), MPI_DOUBLE, all_objs.data(), counts.data(), displs.data(),
+              MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  if (world_rank == 0) {
+    const std::vector<Solution> observed = scorer.score(pats);
+
+    FILE *output;
+    if ((output = fopen(out_file.c_str(), "w")) == nullptr) {
+      fprintf(stderr, "ERROR - Could not open file %s\n", out_file.c_str());
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    fprintf(output, "obj\tboot_mean\tboot_sd\tboot_2.5%%\tboot_97.5%%\tpattern\n");
+    std::vector<double> reps(num_reps);
+    for (std::size_t i = 0; i < pats.size(); ++i) {
+      // Gather the replicates of pattern i from the block of every rank
+      for (int p = 0; p < world_size; ++p) {
+        const std::size_t rank_reps = counts[p] / pats.size();
+        for (std::size_t r = 0; r < rank_reps; ++r) {
+          reps[num_reps * p / world_size + r] = all_objs[displs[p] + i * rank_reps + r];
+        }
+      }
+      std::sort(reps.begin(), reps.end());
+
+      double mean = 0.0, var = 0.0;
+      for (auto v : reps) {
+        mean += v;
+      }
+      mean /= num_reps;
+      for (auto v : reps) {
+        var += (v - mean) * (v - mean);
+      }
+      const double sd = num_reps > 1 ? std::sqrt(var / (num_reps - 1)) : 0.0;
+
+      fprintf(output, "%lf\t%lf\t%lf\t%lf\t%lf\t", observed[i].obj, mean, sd,
+              reps[static_cast<std::size_t>(0.025 * (num_reps - 1) + 0.5)],
+              reps[static_cast<std::size_t>(0.975 * (num_reps - 1) + 0.5)]);
+      for (std::size_t j = 0; j < pats[i].size(); ++j) {
+        fprintf(output, j + 1 < pats[i].size() ? "%u " : "%u", pats[i][j]);
+      }
+      fprintf(output, "\n");
+    }
+    fclose(output);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Folds the individuals in DATA_FILE into the pools and count cache that the
+// run in prev_dir left, and writes the updated pools and count cache to
+// SCRATCH_DIR. Runs on rank 0; the cost grows with the new individuals only.
+//------------------------------------------------------------------------------
+void update_pools(const ConfigParser &parser, std::string prev_dir) {
+  if (Parallel::get_world_rank() != 0) {
+    return;
+  }
+
+  const std::vector<Run> runs = Run::list(parser);
+  if (runs.size() != 1) {
+    throw std::runtime_error("--update takes a single run (no RISK both, STRATA, NUM_FOLDS or lists)");
+  }
+  const Run &run = runs[0];
+  Run::make_dirs(parser, runs);
+
+  if (!prev_dir.empty() && prev_dir.back() != '/') {
+    prev_dir += "/";
+  }
+  CountCache old;
+  if (!old.read(CountCache::file_name(prev_dir))) {
+    fprintf(stderr, "ERROR - No count cache in %s\n", prev_dir.c_str());
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  ExprsData data(parser);
+  if (data.get_num_grp1() == 0 || data.get_num_grp2() == 0) {
+    throw std::runtime_error("--update needs new cases and new controls");
+  }
+  PoolUpdater updater(data, parser.hasParameter("NUM_THREADS") ? parser.getSizeT("NUM_THREADS") : 1);
+
+  std::vector<std::size_t> num_unknown;
+  const CountCache updated = updater.update(old, run.min_obj, run.sol_pool_size, run.max_ps, num_unknown);
+  if (updated.levels.size() < run.max_ps) {
+    fprintf(stderr, "The run in %s only has pools up to PS%lu\n", prev_dir.c_str(), updated.levels.size());
+  }
+
+  PoolWriter writer;
+  const PoolWriter::Format format = PoolWriter::parse_format(parser.hasParameter("POOL_FORMAT") ?
+                                                             parser.getString("POOL_FORMAT") : "text");
+  for (std::size_t k = 1; k <= updated.levels.size(); ++k) {
+    const CountCache::Level &level = updated.levels[k - 1];
+    writer.write(run.scratch_dir + "ps" + std::to_string(k) + ".solPool", level.sols, format);
+
+    if (level.exact) {
+      fprintf(stderr, "Updated PS%lu: %lu patterns, exact\n", k, level.sols.size());
+    } else if (num_unknown[k - 1] > 0) {
+      fprintf(stderr, "Updated PS%lu: %lu patterns; %lu patterns with unknown counts could enter the pool, "
+              "search from PS%lu on the whole cohort for exact pools\n", k, level.sols.size(), num_unknown[k - 1], k);
+    } else {
+      fprintf(stderr, "Updated PS%lu: %lu patterns, not exact since PS%lu is not\n", k, level.sols.size(), k - 1);
+    }
+  }
+  writer.write_counts(CountCache::file_name(run.scratch_dir), updated);
+  writer.wait();
+}
+
+//------------------------------------------------------------------------------
+// Prints the estimated memory, messages and time of a search on num_ranks
+// ranks without running it. With a memory budget (MB per rank), also picks the
+// fastest storage and scheduling settings that fit. Ranks 0 and 1 measure MPI
+// latency and bandwidth if there are two; the rest of the work is on rank 0.
+//------------------------------------------------------------------------------
+void estimate(const ConfigParser &parser, const std::string &ranks_arg, const std::string &budget_arg) {
+  const int world_rank = Parallel::get_world_rank();
+  if (world_rank == 1) {
+    Estimator::echo_mpi();
+  }
+  if (world_rank != 0) {
+    return;
+  }
+
+  char *end;
+  const std::size_t num_ranks = strtoul(ranks_arg.c_str(), &end, 10);
+  if (ranks_arg.empty() || ranks_arg.find_first_not_of("0123456789") != std::string::npos || *end != '\0') {
+    fprintf(stderr, "ERROR - Invalid number of ranks '%s'\n", ranks_arg.c_str());
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  Estimator estimator(parser, num_ranks);
+  estimator.calibrate();
+  if (Parallel::get_world_size() > 1) {
+    estimator.calibrate_mpi();
+  }
+  estimator.report(stderr, estimator.get_configured());
+
+  if (budget_arg.empty()) {
+    return;
+  }
+  const double budget = strtod(budget_arg.c_str(), &end) * 1024.0 * 1024.0;
+  if (*end != '\0' || budget < 0.0) {
+    fprintf(stderr, "ERROR - Invalid memory budget '%s' MB per rank\n", budget_arg.c_str());
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  const Estimator::Settings *best = nullptr;
+  double best_seconds = 0.0;
+  std::vector<Estimator::Settings> candidates = estimator.get_candidates();
+  for (auto &c : candidates) {
+    const double seconds = estimator.get_seconds(c);
+    if (std::max(estimator.get_controller_bytes(c), estimator.get_worker_bytes(c)) <= budget &&
+        (best == nullptr || seconds < best_seconds)) {
+      best = &c;
+      best_seconds = seconds;
+    }
+  }
+
+  fprintf(stderr, "\n");
+  if (best == nullptr) {
+    fprintf(stderr, "No settings fit in %s MB per rank; use more memory per rank or a smaller SOL_POOL_SIZE\n",
+            budget_arg.c_str());
+    return;
+  }
+
+  fprintf(stderr, "Fastest settings within %s MB per rank:\n", budget_arg.c_str());
+  estimator.report(stderr, *best);
+  fprintf(stderr, "\nSPARSE_DENSITY  %g\nSCHEDULER       %s\nWORKER_POOLS    %s\nNUMA_POLICY     %s\n",
+          best->sparse_density, best->scheduler.c_str(), best->worker_pools ? "true" : "false",
+          Numa::get_policy_name(best->numa_policy));
+}
+
+//------------------------------------------------------------------------------
+// Runs the greedy search of the current run from PS1 (or the level after its
+// checkpoint, or after the last level of the previous run of a sweep) to MAX_PS,
+// or until a stopping rule ends it
+//------------------------------------------------------------------------------
+void run_greedy(GreedyController &controller, const Run &run, const bool resume) {
+  Timer timer;
+
+  std::size_t completed_ps = 0;
+  if (resume) {
+    completed_ps = controller.resume();
+    fprintf(stderr, "Resuming after PS%lu\n", completed_ps);
+    if (!controller.get_stop_reason().empty()) {
+      fprintf(stderr, "Run is complete: %s\n", controller.get_stop_reason().c_str());
+      return;
+    }
+  }
+
+  // Logs and returns whether a stopping rule ended the run after the level
+  auto stopped = [&controller](const std::size_t ps) {
+    if (controller.get_stop_reason().empty()) {
+      return false;
+    }
+    fprintf(stderr, "Stopping after PS%lu: %s\n", ps, controller.get_stop_reason().c_str());
+    return true;
+  };
+
+  if (completed_ps == 0) {
+    completed_ps = controller.continue_previous_run();
+    if (completed_ps > 0) {
+      fprintf(stderr, "Continuing from the previous run after PS%lu\n", completed_ps);
+    }
+  }
+
+  if (completed_ps < 1) {
+    fprintf(stderr, "Starting PS1\n");
+    timer.start();
+    controller.solve_ps1();
+    timer.stop();
+    fprintf(stderr, "PS1 took %lf\n", timer.elapsed_wall_time());
+    if (stopped(1)) {
+      return;
+    }
+  }
+
+  if (completed_ps < 2) {
+    fprintf(stderr, "Starting PS2\n");
+    timer.restart();
+    controller.solve_ps2();
+    timer.stop();
+    fprintf(stderr, "PS2 took %lf\n", timer.elapsed_wall_time());
+    if (stopped(2)) {
+      return;
+    }
+  }
+
+  for (std::size_t PS = std::max<std::size_t>(3, completed_ps + 1); PS <= run.max_ps; ++PS) {
+    fprintf(stderr, "Starting PS%lu\n", PS);
+    controller.set_ps(PS);
+    timer.restart();
+    controller.solve();
+    timer.stop();
+
+    fprintf(stderr, "PS%lu took %lf\n\n", PS, timer.elapsed_wall_time());
+    if (stopped(PS)) {
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Runs the exact search of the current run for patterns of the given size
+//------------------------------------------------------------------------------
+void run_exact(GreedyController &controller, const std::size_t size) {
+  Timer timer;
+
+  fprintf(stderr, "Starting exact search for PS%lu\n", size);
+  timer.start();
+  controller.solve_exact(size);
+  timer.stop();
+  fprintf(stderr, "Exact PS%lu took %lf\n", size, timer.elapsed_wall_time());
+}
+
 int main(int argc, char *argv[]) {
   // MPI init
   MPI_Init(NULL, NULL);
   const int world_rank = Parallel::get_world_rank();
   const int world_size = Parallel::get_world_size();
 
+  const bool resume = (argc == 3 && strcmp(argv[2], "--resume") == 0);
+  const bool score = (argc == 5 && strcmp(argv[2], "--score") == 0);
+  const bool exact = (argc == 4 && strcmp(argv[2], "--exact") == 0);
+  const bool permute = (argc == 5 && strcmp(argv[2], "--permute") == 0);
+  const bool bootstrap = (argc == 5 && strcmp(argv[2], "--bootstrap") == 0);
+  const bool update = (argc == 4 && strcmp(argv[2], "--update") == 0);
+  const bool estimate_only = ((argc == 4 || argc == 5) && strcmp(argv[2], "--estimate") == 0);
+
   try {
     if (world_rank == 0) {
       // Check user inputs
-      if (argc != 2) {
-        fprintf(stderr, "Usage: %s <config_file>\n", argv[0]);
+      if (argc != 2 && !resume && !score && !exact && !permute && !bootstrap && !update && !estimate_only) {
+        fprintf(stderr, "Usage: %s <config_file> [--resume]\n", argv[0]);
+        fprintf(stderr, "       %s <config_file> --score <pattern_file> <output_file>\n", argv[0]);
+        fprintf(stderr, "       %s <config_file> --exact <pattern_size>\n", argv[0]);
+        fprintf(stderr, "       %s <config_file> --permute <pattern_file> <output_file>\n", argv[0]);
+        fprintf(stderr, "       %s <config_file> --bootstrap <pattern_file> <output_file>\n", argv[0]);
+        fprintf(stderr, "       %s <config_file> --update <previous_scratch_dir>\n", argv[0]);
+        fprintf(stderr, "       %s <config_file> --estimate <num_ranks> [<memory_mb_per_rank>]\n", argv[0]);
         MPI_Abort(MPI_COMM_WORLD, 1);
-      } else if (world_size < 2) {
+      } else if (world_size < 2 && !score && !permute && !bootstrap && !update && !estimate_only) {
         fprintf(stderr, "world_size must be greater than 1.\n");
         MPI_Abort(MPI_COMM_WORLD, 1);
       }
@@ -26,30 +464,61 @@ int main(int argc, char *argv[]) {
 
     ConfigParser parser(argv[1]);
 
+    if (score) {
+      score_patterns(parser, argv[3], argv[4]);
+      MPI_Finalize();
+      return 0;
+    }
+
+    if (permute) {
+      permutation_test(parser, argv[3], argv[4]);
+      MPI_Finalize();
+      return 0;
+    }
+
+    if (bootstrap) {
+      bootstrap_patterns(parser, argv[3], argv[4]);
+      MPI_Finalize();
+      return 0;
+    }
+
+    if (update) {
+      update_pools(parser, argv[3]);
+      MPI_Finalize();
+      return 0;
+    }
+
+    if (estimate_only) {
+      estimate(parser, argv[3], argc == 5 ? argv[4] : "");
+      MPI_Finalize();
+      return 0;
+    }
+
     switch (world_rank) {
       case 0: {
-        Timer timer;        
         GreedyController controller(parser);
-        fprintf(stderr, "Starting PS1\n");
-        timer.start();
-        controller.solve_ps1();
-        timer.stop();
-        fprintf(stderr, "PS1 took %lf\n", timer.elapsed_cpu_time());
-
-        fprintf(stderr, "Starting PS2\n");
-        timer.restart();
-        controller.solve_ps2();
-        timer.stop();
-        fprintf(stderr, "PS2 took %lf\n", timer.elapsed_cpu_time());
-
-        for (std::size_t PS=3; PS <= parser.getSizeT("MAX_PS"); ++PS) {
-          fprintf(stderr, "Starting PS%lu\n", PS);
-          controller.set_ps(PS);
-          timer.restart();
-          controller.solve();
-          timer.stop();
-
-          fprintf(stderr, "PS%lu took %lf\n\n", PS, timer.elapsed_cpu_time());
+
+        std::size_t exact_size = 0;
+        if (exact) {
+          exact_size = strtoul(argv[3], nullptr, 10);
+          if (exact_size < 1 || exact_size > Pattern::max_size()) {
+            fprintf(stderr, "Pattern size must be between 1 and %lu.\n", Pattern::max_size());
+            MPI_Abort(MPI_COMM_WORLD, 1);
+          }
+        }
+
+        for (std::size_t r = 0; r < controller.get_runs().size(); ++r) {
+          const Run &run = controller.get_runs()[r];
+          if (!run.name.empty()) {
+            fprintf(stderr, "Starting %s run\n", run.name.c_str());
+          }
+
+          controller.begin_run(r);
+          if (exact) {
+            run_exact(controller, exact_size);
+          } else {
+            run_greedy(controller, run, resume);
+          }
         }
 
         controller.signal_workers_to_end();
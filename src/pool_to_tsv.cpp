@@ -0,0 +1,30 @@
+#include <cstdio>
+#include <cstdlib>
+#include "PoolFile.h"
+
+// Converts a binary solution pool (ps#.solPool.bin) to TSV on stdout
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <pool_file.bin>\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<Solution> sols = PoolFile::read_binary(argv[1]);
+  const std::size_t ps = sols.empty() ? 0 : sols[0].pat.size();
+
+  printf("obj\tf1\tf2");
+  for (std::size_t i = 1; i <= ps; ++i) {
+    printf("\tbin%lu", i);
+  }
+  printf("\n");
+
+  for (auto &s : sols) {
+    printf("%.17g\t%.17g\t%.17g", s.obj, s.f1, s.f2);
+    for (auto p : s.pat) {
+      printf("\t%u", p);
+    }
+    printf("\n");
+  }
+
+  return EXIT_SUCCESS;
+}